@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Wall clock time in seconds.
+ */
+static inline double
+benchmark_now()
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Prints one result line as nanoseconds per operation.
+ */
+static inline void
+benchmark_report(const char* name, double seconds, size_t ops)
+{
+  printf("%-48s %10.2f ns/op\n", name, seconds * 1e9 / (double)ops);
+}
+
+/*
+ * Fills keys and key_lens with n distinct identifier-like keys of roughly
+ * key_len bytes. The key bytes live in one block returned to the caller.
+ */
+static inline char*
+benchmark_keys(char** keys,
+               size_t* key_lens,
+               size_t n,
+               size_t key_len,
+               uint64_t seed)
+{
+  char* data = malloc(n * key_len);
+
+  uint64_t x = seed;
+  for (size_t i = 0; i < n; i++) {
+    char* key = data + i * key_len;
+
+    // splitmix64 for the random tail, index prefix keeps keys distinct
+    int prefix = snprintf(key, key_len, "%zx:", i);
+    for (size_t j = (size_t)prefix; j < key_len; j++) {
+      x += 0x9e3779b97f4a7c15u;
+      uint64_t z = x;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+      key[j] = "abcdefghijklmnopqrstuvwxyz0123456789"[(z ^ (z >> 31)) % 36];
+    }
+
+    keys[i] = key;
+    key_lens[i] = key_len;
+  }
+
+  return data;
+}
+
+#endif /* BENCHMARK_H */
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+#include "bloom_filter.h"
+#include "hash.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_COUNT (1 << 20)
+
+/*
+ * Checks KEY_COUNT misses against a Set and against Bloom filters of the
+ * same keys, the filter being the cheap negative check in front of the set.
+ */
+int
+main()
+{
+  static const double fp_rates[] = { 0.1, 0.01, 0.001 };
+
+  char** keys = malloc(KEY_COUNT * sizeof(char*));
+  size_t* key_lens = malloc(KEY_COUNT * sizeof(size_t));
+  char** misses = malloc(KEY_COUNT * sizeof(char*));
+  size_t* miss_lens = malloc(KEY_COUNT * sizeof(size_t));
+
+  char* data = benchmark_keys(keys, key_lens, KEY_COUNT, 16, 1);
+  char* miss_data = benchmark_keys(misses, miss_lens, KEY_COUNT, 16, 2);
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    misses[i][15] = '#';
+  }
+
+  struct Set* s = Set_new(16);
+  Set_put_batch(s, keys, key_lens, KEY_COUNT);
+
+  size_t found = 0;
+  double start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    found += Set_has(s, misses[i], miss_lens[i]);
+  }
+  benchmark_report("Set_has miss", benchmark_now() - start, KEY_COUNT);
+
+  printf("Set bytes per key: %.1f\n",
+         (double)(s->capacity * sizeof(struct SetItem)) / KEY_COUNT);
+  Set_free(s);
+
+  for (size_t r = 0; r < sizeof(fp_rates) / sizeof(double); r++) {
+    char name[64];
+    struct BloomFilter* f = BloomFilter_new(KEY_COUNT, fp_rates[r]);
+
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+      BloomFilter_add(f, keys[i], key_lens[i]);
+    }
+
+    size_t false_positives = 0;
+    start = benchmark_now();
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+      false_positives += BloomFilter_maybe_has(f, misses[i], miss_lens[i]);
+    }
+    snprintf(name, sizeof(name), "BloomFilter_maybe_has miss/%g", fp_rates[r]);
+    benchmark_report(name, benchmark_now() - start, KEY_COUNT);
+
+    printf("BloomFilter/%g bytes per key: %.1f, false positives: %.4f\n",
+           fp_rates[r],
+           (double)(f->block_count * BLOOM_FILTER_BLOCK_BITS / 8) / KEY_COUNT,
+           (double)false_positives / KEY_COUNT);
+    BloomFilter_free(f);
+  }
+
+  if (found != 0) {
+    fprintf(stderr, "unexpected hit count %zu\n", found);
+    exit(1);
+  }
+
+  free(data);
+  free(miss_data);
+  free(keys);
+  free(key_lens);
+  free(misses);
+  free(miss_lens);
+
+  return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+#include "concurrent_set.h"
+#include "hash.h"
+#include "set.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_COUNT (1 << 18)
+#define OPS_PER_THREAD (1 << 18)
+#define MAX_THREADS 32
+
+struct worker
+{
+  struct ConcurrentSet* concurrent;
+  struct Set* locked;
+  pthread_mutex_t* mutex;
+  char** keys;
+  size_t* key_lens;
+  unsigned int read_percent;
+  uint64_t rng;
+  size_t found;
+};
+
+static uint64_t
+worker_next(struct worker* w)
+{
+  w->rng += 0x9e3779b97f4a7c15u;
+  uint64_t z = w->rng;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+  return z ^ (z >> 31);
+}
+
+/*
+ * Runs a mix of lookups and writes, where a write deletes or re-adds a key
+ * so the set keeps its size.
+ */
+static void*
+worker_run(void* arg)
+{
+  struct worker* w = arg;
+
+  for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+    uint64_t r = worker_next(w);
+    size_t idx = (size_t)(r >> 32) % KEY_COUNT;
+    char* key = w->keys[idx];
+    size_t key_len = w->key_lens[idx];
+    int read = r % 100 < w->read_percent;
+
+    if (w->concurrent != NULL) {
+      if (read) {
+        w->found += ConcurrentSet_has(w->concurrent, key, key_len);
+      } else if (r & 0x100) {
+        ConcurrentSet_delete(w->concurrent, key, key_len);
+      } else {
+        ConcurrentSet_put(w->concurrent, key, key_len);
+      }
+      continue;
+    }
+
+    pthread_mutex_lock(w->mutex);
+    if (read) {
+      w->found += Set_has(w->locked, key, key_len);
+    } else if (r & 0x100) {
+      Set_delete(w->locked, key, key_len);
+    } else {
+      Set_put(w->locked, key, key_len);
+    }
+    pthread_mutex_unlock(w->mutex);
+  }
+
+  return NULL;
+}
+
+static void
+benchmark_mix(const char* label,
+              struct ConcurrentSet* concurrent,
+              struct Set* locked,
+              char** keys,
+              size_t* key_lens,
+              unsigned int read_percent,
+              size_t threads)
+{
+  char name[64];
+  struct worker workers[MAX_THREADS];
+  pthread_t handles[MAX_THREADS];
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+  double start = benchmark_now();
+  for (size_t t = 0; t < threads; t++) {
+    workers[t] = (struct worker){
+      .concurrent = concurrent,
+      .locked = locked,
+      .mutex = &mutex,
+      .keys = keys,
+      .key_lens = key_lens,
+      .read_percent = read_percent,
+      .rng = t + 1,
+      .found = 0,
+    };
+    pthread_create(&handles[t], NULL, worker_run, &workers[t]);
+  }
+  for (size_t t = 0; t < threads; t++) {
+    pthread_join(handles[t], NULL);
+  }
+
+  snprintf(name,
+           sizeof(name),
+           "%s/%u%% reads/%zu threads",
+           label,
+           read_percent,
+           threads);
+  benchmark_report(name, benchmark_now() - start, threads * OPS_PER_THREAD);
+}
+
+int
+main()
+{
+  static const unsigned int read_percents[] = { 100, 90, 50 };
+  static const size_t threads_tested[] = { 1, 2, 4, 8, 16, 32 };
+
+  char** keys = malloc(KEY_COUNT * sizeof(char*));
+  size_t* key_lens = malloc(KEY_COUNT * sizeof(size_t));
+  char* data = benchmark_keys(keys, key_lens, KEY_COUNT, 16, 1);
+
+  for (size_t r = 0; r < sizeof(read_percents) / sizeof(unsigned int); r++) {
+    for (size_t t = 0; t < sizeof(threads_tested) / sizeof(size_t); t++) {
+      // One global mutex around a plain Set, the baseline being replaced
+      struct Set* locked = Set_new(16);
+      Set_put_batch(locked, keys, key_lens, KEY_COUNT);
+      benchmark_mix("Set+mutex",
+                    NULL,
+                    locked,
+                    keys,
+                    key_lens,
+                    read_percents[r],
+                    threads_tested[t]);
+      Set_free(locked);
+
+      struct ConcurrentSet* concurrent = ConcurrentSet_new(16, 64);
+      for (size_t i = 0; i < KEY_COUNT; i++) {
+        ConcurrentSet_put(concurrent, keys[i], key_lens[i]);
+      }
+      benchmark_mix("ConcurrentSet",
+                    concurrent,
+                    NULL,
+                    keys,
+                    key_lens,
+                    read_percents[r],
+                    threads_tested[t]);
+      ConcurrentSet_free(concurrent);
+    }
+  }
+
+  free(data);
+  free(keys);
+  free(key_lens);
+
+  return 0;
+}
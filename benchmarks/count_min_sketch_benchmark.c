@@ -0,0 +1,107 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+#include "count_min_sketch.h"
+#include "map.h"
+#include "set.h"
+#include "top_k.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KEY_COUNT (1 << 20)
+#define UPDATE_COUNT (1 << 22)
+#define KEY_LEN 16
+
+static void
+report_throughput(const char* name, double seconds)
+{
+  benchmark_report(name, seconds, UPDATE_COUNT);
+  printf("%-48s %10.2f Mupdates/s\n", name, UPDATE_COUNT / seconds / 1e6);
+}
+
+/*
+ * Measures update throughput of a CountMinSketch and TopK over a skewed
+ * stream, against counting every key exactly in a Map.
+ */
+int
+main()
+{
+  char** keys = malloc(KEY_COUNT * sizeof(char*));
+  size_t* key_lens = malloc(KEY_COUNT * sizeof(size_t));
+  char* stream = malloc((size_t)UPDATE_COUNT * KEY_LEN);
+
+  char* data = benchmark_keys(keys, key_lens, KEY_COUNT, KEY_LEN, 1);
+
+  // Cubing a uniform draw puts about half of the updates on the first 12%
+  // of keys. The stream holds copies of the keys in arrival order, so
+  // updates read their keys sequentially as they would off the wire.
+  uint64_t x = 1;
+  for (size_t i = 0; i < UPDATE_COUNT; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    double u = (double)(x >> 11) / (double)(1ull << 53);
+    char* key = keys[(size_t)(u * u * u * KEY_COUNT)];
+    memcpy(stream + i * KEY_LEN, key, KEY_LEN);
+  }
+
+  struct CountMinSketch* cms = CountMinSketch_new(0.0001, 0.01);
+
+  double start = benchmark_now();
+  for (size_t i = 0; i < UPDATE_COUNT; i++) {
+    CountMinSketch_add(cms, stream + i * KEY_LEN, KEY_LEN, 1);
+  }
+  report_throughput("CountMinSketch_add", benchmark_now() - start);
+
+  printf("CountMinSketch bytes: %zu\n",
+         cms->width * cms->depth * sizeof(uint32_t));
+  CountMinSketch_free(cms);
+
+  struct TopK* t = TopK_new(100, 0.0001, 0.01);
+
+  start = benchmark_now();
+  for (size_t i = 0; i < UPDATE_COUNT; i++) {
+    TopK_add(t, stream + i * KEY_LEN, KEY_LEN, 1);
+  }
+  report_throughput("TopK_add k=100", benchmark_now() - start);
+  TopK_free(t);
+
+  struct Map* m = Map_new(16);
+
+  start = benchmark_now();
+  for (size_t i = 0; i < UPDATE_COUNT; i++) {
+    int inserted;
+    struct SetItem* item = Set_insert_or_find(
+      m->set, stream + i * KEY_LEN, KEY_LEN, &inserted);
+    void** count = Set_value(m->set, item);
+    *count = (void*)((uintptr_t)*count + 1);
+  }
+  report_throughput("Map count", benchmark_now() - start);
+
+  printf("Map bytes: %zu\n", m->set->capacity * m->set->item_size);
+  Map_free(m);
+
+  free(data);
+  free(keys);
+  free(key_lens);
+  free(stream);
+
+  return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+#include "cuckoo_filter.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_COUNT (1 << 20)
+
+/*
+ * Compares the speed, size and false positive rate of a CuckooFilter with a
+ * Set holding the same keys.
+ */
+int
+main()
+{
+  char** keys = malloc(KEY_COUNT * sizeof(char*));
+  size_t* key_lens = malloc(KEY_COUNT * sizeof(size_t));
+  char** misses = malloc(KEY_COUNT * sizeof(char*));
+  size_t* miss_lens = malloc(KEY_COUNT * sizeof(size_t));
+
+  char* data = benchmark_keys(keys, key_lens, KEY_COUNT, 16, 1);
+  char* miss_data = benchmark_keys(misses, miss_lens, KEY_COUNT, 16, 2);
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    misses[i][15] = '#';
+  }
+
+  struct CuckooFilter* f = CuckooFilter_new(KEY_COUNT);
+
+  double start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    CuckooFilter_add(f, keys[i], key_lens[i]);
+  }
+  benchmark_report("CuckooFilter_add", benchmark_now() - start, KEY_COUNT);
+
+  size_t found = 0;
+  start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    found += CuckooFilter_has(f, keys[i], key_lens[i]);
+  }
+  benchmark_report("CuckooFilter_has hit", benchmark_now() - start, KEY_COUNT);
+
+  size_t false_positives = 0;
+  start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    false_positives += CuckooFilter_has(f, misses[i], miss_lens[i]);
+  }
+  benchmark_report("CuckooFilter_has miss", benchmark_now() - start, KEY_COUNT);
+
+  start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    CuckooFilter_delete(f, keys[i], key_lens[i]);
+  }
+  benchmark_report("CuckooFilter_delete", benchmark_now() - start, KEY_COUNT);
+
+  printf("CuckooFilter bytes per key: %.1f, false positives: %.5f\n",
+         (double)(f->bucket_count * CUCKOO_FILTER_BUCKET_SIZE *
+                  sizeof(uint16_t)) /
+           KEY_COUNT,
+         (double)false_positives / KEY_COUNT);
+  CuckooFilter_free(f);
+
+  struct Set* s = Set_new(16);
+  Set_put_batch(s, keys, key_lens, KEY_COUNT);
+
+  start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    found += Set_has(s, misses[i], miss_lens[i]);
+  }
+  benchmark_report("Set_has miss", benchmark_now() - start, KEY_COUNT);
+
+  printf("Set bytes per key: %.1f\n",
+         (double)(s->capacity * sizeof(struct SetItem)) / KEY_COUNT);
+  Set_free(s);
+
+  if (found != KEY_COUNT) {
+    fprintf(stderr, "unexpected hit count %zu\n", found);
+    exit(1);
+  }
+
+  free(data);
+  free(miss_data);
+  free(keys);
+  free(key_lens);
+  free(misses);
+  free(miss_lens);
+
+  return 0;
+}
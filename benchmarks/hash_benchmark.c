@@ -0,0 +1,91 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+#include "hash.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_COUNT (1 << 16)
+#define ROUNDS 16
+
+static const size_t KEY_LENS[] = { 4, 8, 16, 32, 64, 128, 256, 1024 };
+
+static void
+benchmark_hash(const char* label,
+               HashFunction hash,
+               char** keys,
+               size_t* key_lens,
+               size_t key_len,
+               uint64_t* out)
+{
+  char name[64];
+
+  uint64_t sum = 0;
+  double start = benchmark_now();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+      sum += hash(keys[i], key_lens[i], (uint64_t)r);
+    }
+  }
+  snprintf(name, sizeof(name), "%s/%zuB", label, key_len);
+  benchmark_report(name, benchmark_now() - start, KEY_COUNT * ROUNDS);
+
+  start = benchmark_now();
+  for (int r = 0; r < ROUNDS; r++) {
+    hash_many(hash, (uint64_t)r, keys, key_lens, KEY_COUNT, out);
+    sum += out[r];
+  }
+  snprintf(name, sizeof(name), "%s/%zuB/hash_many", label, key_len);
+  benchmark_report(name, benchmark_now() - start, KEY_COUNT * ROUNDS);
+
+  // Keep the single key loop from being optimized out
+  if (sum == 0) {
+    printf("\n");
+  }
+}
+
+/*
+ * Hashes keys of each length one at a time and in bulk with hash_many, for
+ * each hash function.
+ */
+int
+main()
+{
+  char** keys = malloc(KEY_COUNT * sizeof(char*));
+  size_t* key_lens = malloc(KEY_COUNT * sizeof(size_t));
+  uint64_t* out = malloc(KEY_COUNT * sizeof(uint64_t));
+
+  for (size_t l = 0; l < sizeof(KEY_LENS) / sizeof(KEY_LENS[0]); l++) {
+    char* data = benchmark_keys(keys, key_lens, KEY_COUNT, KEY_LENS[l], 1);
+
+    benchmark_hash(
+      "fnv_1a", fnv_1a_hash_seeded, keys, key_lens, KEY_LENS[l], out);
+    benchmark_hash("wyhash", wyhash, keys, key_lens, KEY_LENS[l], out);
+    benchmark_hash(
+      "crc32c", crc32c_hash, keys, key_lens, KEY_LENS[l], out);
+
+    free(data);
+  }
+
+  free(keys);
+  free(key_lens);
+  free(out);
+
+  return 0;
+}
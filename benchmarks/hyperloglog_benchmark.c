@@ -0,0 +1,73 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+#include "hyperloglog.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_COUNT (1 << 20)
+
+/*
+ * Compares counting distinct keys with a HyperLogLog against building a Set
+ * and reading its load.
+ */
+int
+main()
+{
+  char** keys = malloc(KEY_COUNT * sizeof(char*));
+  size_t* key_lens = malloc(KEY_COUNT * sizeof(size_t));
+
+  char* data = benchmark_keys(keys, key_lens, KEY_COUNT, 16, 1);
+
+  struct HyperLogLog* h = HyperLogLog_new(14);
+
+  double start = benchmark_now();
+  HyperLogLog_add_keys(h, keys, key_lens, KEY_COUNT);
+  benchmark_report("HyperLogLog_add_keys", benchmark_now() - start, KEY_COUNT);
+
+  start = benchmark_now();
+  size_t estimate = HyperLogLog_estimate(h);
+  benchmark_report("HyperLogLog_estimate", benchmark_now() - start, 1);
+
+  printf("HyperLogLog bytes: %zu, estimate: %zu, error: %.4f\n",
+         (size_t)1 << h->precision,
+         estimate,
+         ((double)estimate - KEY_COUNT) / KEY_COUNT);
+  HyperLogLog_free(h);
+
+  struct Set* s = Set_new(16);
+
+  start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    Set_put(s, keys[i], key_lens[i]);
+  }
+  benchmark_report("Set_put", benchmark_now() - start, KEY_COUNT);
+
+  printf("Set bytes: %zu, load: %zu\n",
+         s->capacity * sizeof(struct SetItem),
+         s->load);
+  Set_free(s);
+
+  free(data);
+  free(keys);
+  free(key_lens);
+
+  return 0;
+}
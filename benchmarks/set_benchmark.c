@@ -0,0 +1,268 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+#include "hash.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_COUNT (1 << 20)
+
+static void
+benchmark_set(const char* label,
+              unsigned int flags,
+              HashFunction hash,
+              size_t key_len,
+              char** keys,
+              size_t* key_lens,
+              char** misses,
+              size_t* miss_lens)
+{
+  char name[64];
+
+  struct Set* s = Set_new_with_options(16, flags, hash, 0);
+
+  double start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    Set_put(s, keys[i], key_lens[i]);
+  }
+  snprintf(name, sizeof(name), "%s/%zuB/Set_put", label, key_len);
+  benchmark_report(name, benchmark_now() - start, KEY_COUNT);
+
+  size_t found = 0;
+  start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    found += Set_has(s, keys[i], key_lens[i]);
+  }
+  snprintf(name, sizeof(name), "%s/%zuB/Set_has hit", label, key_len);
+  benchmark_report(name, benchmark_now() - start, KEY_COUNT);
+
+  start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    found += Set_has(s, misses[i], miss_lens[i]);
+  }
+  snprintf(name, sizeof(name), "%s/%zuB/Set_has miss", label, key_len);
+  benchmark_report(name, benchmark_now() - start, KEY_COUNT);
+
+  int* results = malloc(KEY_COUNT * sizeof(int));
+
+  start = benchmark_now();
+  Set_has_batch(s, keys, key_lens, KEY_COUNT, results);
+  snprintf(name, sizeof(name), "%s/%zuB/Set_has_batch hit", label, key_len);
+  benchmark_report(name, benchmark_now() - start, KEY_COUNT);
+
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    found += (size_t)results[i];
+  }
+
+  start = benchmark_now();
+  Set_has_batch(s, misses, miss_lens, KEY_COUNT, results);
+  snprintf(name, sizeof(name), "%s/%zuB/Set_has_batch miss", label, key_len);
+  benchmark_report(name, benchmark_now() - start, KEY_COUNT);
+
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    found += (size_t)results[i];
+  }
+
+  free(results);
+
+  if (found != 2 * KEY_COUNT) {
+    fprintf(stderr, "unexpected hit count %zu\n", found);
+    exit(1);
+  }
+
+  start = benchmark_now();
+  Set_free(s);
+  snprintf(name, sizeof(name), "%s/%zuB/Set_free", label, key_len);
+  benchmark_report(name, benchmark_now() - start, KEY_COUNT);
+}
+
+static int
+compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+/*
+ * Times every Set_put on its own and prints tail latencies, which is where
+ * a stop-the-world resize shows up and an incremental one should not.
+ */
+static void
+benchmark_put_latency(const char* label,
+                      unsigned int flags,
+                      char** keys,
+                      size_t* key_lens)
+{
+  double* samples = malloc(KEY_COUNT * sizeof(double));
+
+  struct Set* s = Set_new_with_options(16, flags, wyhash, 0);
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    double start = benchmark_now();
+    Set_put(s, keys[i], key_lens[i]);
+    samples[i] = benchmark_now() - start;
+  }
+  Set_free(s);
+
+  qsort(samples, KEY_COUNT, sizeof(double), compare_double);
+
+  printf("%-48s p50 %8.0f ns  p99 %8.0f ns  max %10.0f ns\n",
+         label,
+         samples[KEY_COUNT / 2] * 1e9,
+         samples[KEY_COUNT - KEY_COUNT / 100] * 1e9,
+         samples[KEY_COUNT - 1] * 1e9);
+
+  free(samples);
+}
+
+/*
+ * Intersects and unions two sets of KEY_COUNT keys that share half their
+ * keys, sequentially and then with increasing thread counts.
+ */
+static void
+benchmark_set_algebra(char** keys, size_t* key_lens)
+{
+  static const size_t threads_tested[] = { 1, 2, 4, 8, 16 };
+
+  char name[64];
+
+  struct Set* s_a = Set_new(16);
+  struct Set* s_b = Set_new(16);
+  Set_put_batch(s_a, keys, key_lens, KEY_COUNT);
+  Set_put_batch(s_b, keys + KEY_COUNT / 2, key_lens, KEY_COUNT / 2);
+
+  double start = benchmark_now();
+  struct Set* res = Set_intersection(s_a, s_b);
+  benchmark_report(
+    "wyhash/16B/Set_intersection", benchmark_now() - start, KEY_COUNT);
+  Set_free(res);
+
+  start = benchmark_now();
+  res = Set_union(s_a, s_b);
+  benchmark_report("wyhash/16B/Set_union", benchmark_now() - start, KEY_COUNT);
+  Set_free(res);
+
+  for (size_t i = 0; i < sizeof(threads_tested) / sizeof(size_t); i++) {
+    size_t threads = threads_tested[i];
+
+    start = benchmark_now();
+    res = Set_intersection_parallel(s_a, s_b, threads);
+    snprintf(
+      name, sizeof(name), "wyhash/16B/Set_intersection_parallel/%zu", threads);
+    benchmark_report(name, benchmark_now() - start, KEY_COUNT);
+    Set_free(res);
+
+    start = benchmark_now();
+    res = Set_union_parallel(s_a, s_b, threads);
+    snprintf(name, sizeof(name), "wyhash/16B/Set_union_parallel/%zu", threads);
+    benchmark_report(name, benchmark_now() - start, KEY_COUNT);
+    Set_free(res);
+  }
+
+  Set_free(s_a);
+  Set_free(s_b);
+}
+
+int
+main()
+{
+  static const size_t key_lens_tested[] = { 8, 40, 200 };
+
+  char** keys = malloc(KEY_COUNT * sizeof(char*));
+  size_t* key_lens = malloc(KEY_COUNT * sizeof(size_t));
+  char** misses = malloc(KEY_COUNT * sizeof(char*));
+  size_t* miss_lens = malloc(KEY_COUNT * sizeof(size_t));
+
+  for (size_t i = 0; i < sizeof(key_lens_tested) / sizeof(size_t); i++) {
+    size_t key_len = key_lens_tested[i];
+
+    char* data = benchmark_keys(keys, key_lens, KEY_COUNT, key_len, 1);
+    char* miss_data = benchmark_keys(misses, miss_lens, KEY_COUNT, key_len, 2);
+
+    // Misses share the index prefix, so make them differ from every key
+    for (size_t j = 0; j < KEY_COUNT; j++) {
+      misses[j][key_len - 1] = '#';
+    }
+
+    benchmark_set("fnv_1a",
+                  0,
+                  fnv_1a_hash_seeded,
+                  key_len,
+                  keys,
+                  key_lens,
+                  misses,
+                  miss_lens);
+    benchmark_set(
+      "wyhash", 0, wyhash, key_len, keys, key_lens, misses, miss_lens);
+    benchmark_set(
+      "crc32c", 0, crc32c_hash, key_len, keys, key_lens, misses, miss_lens);
+    benchmark_set("wyhash/pow2",
+                  SET_POW2_CAPACITY,
+                  wyhash,
+                  key_len,
+                  keys,
+                  key_lens,
+                  misses,
+                  miss_lens);
+    benchmark_set("wyhash/robin_hood",
+                  SET_ROBIN_HOOD,
+                  wyhash,
+                  key_len,
+                  keys,
+                  key_lens,
+                  misses,
+                  miss_lens);
+    benchmark_set("wyhash/arena",
+                  SET_ARENA_KEYS,
+                  wyhash,
+                  key_len,
+                  keys,
+                  key_lens,
+                  misses,
+                  miss_lens);
+    benchmark_set("wyhash/swiss",
+                  SET_SWISS_TABLE,
+                  wyhash,
+                  key_len,
+                  keys,
+                  key_lens,
+                  misses,
+                  miss_lens);
+
+    free(data);
+    free(miss_data);
+  }
+
+  char* data = benchmark_keys(keys, key_lens, KEY_COUNT, 16, 3);
+  benchmark_put_latency("wyhash/16B/Set_put latency", 0, keys, key_lens);
+  benchmark_put_latency("wyhash/16B/Set_put latency incremental",
+                        SET_INCREMENTAL_RESIZE,
+                        keys,
+                        key_lens);
+  benchmark_set_algebra(keys, key_lens);
+  free(data);
+
+  free(keys);
+  free(key_lens);
+  free(misses);
+  free(miss_lens);
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+#include "set.h"
+#include "u64_set.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_COUNT (1 << 20)
+
+/*
+ * Compares U64Set against a Set holding the same IDs formatted as decimal
+ * strings, the workaround it replaces.
+ */
+int
+main()
+{
+  uint64_t* ids = malloc(2 * KEY_COUNT * sizeof(uint64_t));
+
+  // The second half are misses
+  uint64_t x = 1;
+  for (size_t i = 0; i < 2 * KEY_COUNT; i++) {
+    x += 0x9e3779b97f4a7c15u;
+    ids[i] = x;
+  }
+
+  struct U64Set* u = U64Set_new(16);
+
+  double start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    U64Set_put(u, ids[i]);
+  }
+  benchmark_report("U64Set_put", benchmark_now() - start, KEY_COUNT);
+
+  size_t found = 0;
+  start = benchmark_now();
+  for (size_t i = 0; i < 2 * KEY_COUNT; i++) {
+    found += U64Set_has(u, ids[i]);
+  }
+  benchmark_report(
+    "U64Set_has 50% hit", benchmark_now() - start, 2 * KEY_COUNT);
+
+  printf("U64Set bytes per key: %.1f\n",
+         (double)(u->capacity * sizeof(uint64_t)) / KEY_COUNT);
+  U64Set_free(u);
+
+  char key[24];
+  struct Set* s = Set_new(16);
+
+  start = benchmark_now();
+  for (size_t i = 0; i < KEY_COUNT; i++) {
+    int key_len =
+      snprintf(key, sizeof(key), "%llu", (unsigned long long)ids[i]);
+    Set_put(s, key, key_len);
+  }
+  benchmark_report("Set_put formatted", benchmark_now() - start, KEY_COUNT);
+
+  start = benchmark_now();
+  for (size_t i = 0; i < 2 * KEY_COUNT; i++) {
+    int key_len =
+      snprintf(key, sizeof(key), "%llu", (unsigned long long)ids[i]);
+    found += Set_has(s, key, key_len);
+  }
+  benchmark_report(
+    "Set_has formatted 50% hit", benchmark_now() - start, 2 * KEY_COUNT);
+
+  printf("Set bytes per key: %.1f\n",
+         (double)(s->capacity * sizeof(struct SetItem)) / KEY_COUNT);
+  Set_free(s);
+
+  if (found != 2 * KEY_COUNT) {
+    fprintf(stderr, "unexpected hit count %zu\n", found);
+    exit(1);
+  }
+
+  free(ids);
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+struct ArenaChunk
+{
+  struct ArenaChunk* next;
+  size_t capacity;
+  size_t length;
+  char data[];
+};
+
+/*
+ * Bump allocator for byte strings. Allocations are packed back to back into
+ * large chunks with no alignment and are only released all at once by
+ * Arena_free.
+ */
+struct Arena
+{
+  struct ArenaChunk* chunk;
+  size_t chunk_size;
+};
+
+struct Arena*
+Arena_new(size_t chunk_size);
+
+void
+Arena_free(struct Arena* a);
+
+void*
+Arena_alloc(struct Arena* a, size_t size);
+
+/*
+ * Moves every chunk of src into dst and frees src. Memory allocated from
+ * src stays valid and is released with dst.
+ */
+void
+Arena_merge(struct Arena* dst, struct Arena* src);
+
+#endif /* ARENA_H */
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Bits per block, one 64-byte cache line. A key only ever sets and tests
+ * bits inside the single block its hash selects.
+ */
+#define BLOOM_FILTER_BLOCK_BITS 512
+
+#define BLOOM_FILTER_BLOCK_WORDS (BLOOM_FILTER_BLOCK_BITS / 64)
+
+/*
+ * Blocked Bloom filter. Each key is hashed once with wyhash, the high bits
+ * pick a block and the k bit positions inside it are the top bits of the
+ * hash remixed once per position. Keeping a key's bits in one cache line makes a query a single
+ * memory access, at the cost of a slightly higher false positive rate than
+ * an unblocked filter of the same size.
+ */
+struct BloomFilter
+{
+  uint64_t* blocks;
+  size_t block_count;
+  unsigned int hashes;
+  uint64_t seed;
+};
+
+/*
+ * Sizes the filter for expected_n keys at a false positive rate of about
+ * fp_rate, which must be between 0 and 1.
+ */
+struct BloomFilter*
+BloomFilter_new(size_t expected_n, double fp_rate);
+
+/*
+ * Same as BloomFilter_new, with the seed passed to wyhash. Filters with
+ * different seeds set different bits for the same keys.
+ */
+struct BloomFilter*
+BloomFilter_new_with_seed(size_t expected_n, double fp_rate, uint64_t seed);
+
+void
+BloomFilter_free(struct BloomFilter* f);
+
+void
+BloomFilter_add(struct BloomFilter* f, char* key, size_t key_len);
+
+/*
+ * Returns 0 when the key was never added, and 1 when it probably was.
+ */
+int
+BloomFilter_maybe_has(struct BloomFilter* f, char* key, size_t key_len);
+
+/*
+ * Returns a filter holding the keys of both. The filters must have been
+ * created with the same expected_n, fp_rate and seed.
+ */
+struct BloomFilter*
+BloomFilter_union(struct BloomFilter* f_a, struct BloomFilter* f_b);
+
+#endif /* BLOOM_FILTER_H */
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONCURRENT_SET_H
+#define CONCURRENT_SET_H
+
+#include "hash.h"
+#include "segmented_set.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Set that is safe to share between threads. Keys are split across
+ * independently locked segments by the top bits of their hash, so lookups
+ * only share a lock with other lookups of the same segment and writers
+ * only block their own segment. Each key is hashed once, and the hash is
+ * reused inside the segment. Segments are guarded by reader-writer locks.
+ */
+struct ConcurrentSet
+{
+  struct SegmentedSet base;
+};
+
+struct ConcurrentSet*
+ConcurrentSet_new(size_t inital_capacity, size_t segment_count);
+
+/*
+ * Segments are created with the given Set options, except
+ * SET_INCREMENTAL_RESIZE, which lets lookups move entries and so cannot be
+ * used under a read lock. It is ignored when passed. The segment count is
+ * rounded up to a power of two.
+ */
+struct ConcurrentSet*
+ConcurrentSet_new_with_options(size_t inital_capacity,
+                               size_t segment_count,
+                               unsigned int flags,
+                               HashFunction hash,
+                               uint64_t seed);
+
+void
+ConcurrentSet_free(struct ConcurrentSet* s);
+
+int
+ConcurrentSet_has(struct ConcurrentSet* s, char* key, size_t key_len);
+
+/*
+ * Adds the key if missing. Returns 1 when it was added, otherwise 0.
+ */
+int
+ConcurrentSet_put(struct ConcurrentSet* s, char* key, size_t key_len);
+
+void
+ConcurrentSet_delete(struct ConcurrentSet* s, char* key, size_t key_len);
+
+/*
+ * Number of keys, counted one segment at a time.
+ */
+size_t
+ConcurrentSet_load(struct ConcurrentSet* s);
+
+#endif /* CONCURRENT_SET_H */
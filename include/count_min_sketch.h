@@ -0,0 +1,85 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COUNT_MIN_SKETCH_H
+#define COUNT_MIN_SKETCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define COUNT_MIN_SKETCH_MAX_DEPTH 16
+
+/*
+ * Count-Min sketch with conservative update. Each key maps to one counter
+ * per row, and its estimate is the smallest of them. Estimates never fall
+ * below the true count, and overshoot by at most epsilon * total with
+ * probability 1 - delta. Conservative update only raises the counters that
+ * are below the new estimate, which keeps the overshoot well under that
+ * bound on skewed streams.
+ *
+ * Rows are indexed by double hashing a single fnv_1a_hash_seeded of the
+ * key. Counters are 32 bits and saturate instead of wrapping.
+ *
+ * Reference:
+ * http://dimacs.rutgers.edu/~graham/pubs/papers/cm-full.pdf
+ */
+struct CountMinSketch
+{
+  uint32_t* counters;
+  size_t width;
+  unsigned int depth;
+  uint64_t seed;
+  uint64_t total;
+};
+
+/*
+ * Sizes the sketch for an error of epsilon * total with probability
+ * 1 - delta. Both must be between 0 and 1.
+ */
+struct CountMinSketch*
+CountMinSketch_new(double epsilon, double delta);
+
+/*
+ * Creates a sketch with depth rows of width counters. The width is rounded
+ * up to a power of 2.
+ */
+struct CountMinSketch*
+CountMinSketch_new_with_size(size_t width, unsigned int depth, uint64_t seed);
+
+void
+CountMinSketch_free(struct CountMinSketch* cms);
+
+/*
+ * Adds count occurrences of the key and returns its new estimate.
+ */
+uint32_t
+CountMinSketch_add(struct CountMinSketch* cms,
+                   char* key,
+                   size_t key_len,
+                   uint32_t count);
+
+uint32_t
+CountMinSketch_estimate(struct CountMinSketch* cms, char* key, size_t key_len);
+
+/*
+ * Adds the counters of src to dst. Both must have the same width, depth and
+ * seed. The result still never underestimates, but is looser than a single
+ * sketch fed both streams.
+ */
+void
+CountMinSketch_merge(struct CountMinSketch* dst, struct CountMinSketch* src);
+
+#endif /* COUNT_MIN_SKETCH_H */
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CUCKOO_FILTER_H
+#define CUCKOO_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CUCKOO_FILTER_BUCKET_SIZE 4
+
+/*
+ * Approximate membership filter that supports deletion. Each key is stored
+ * as a 16-bit fingerprint in one of two 4-slot buckets, the second found
+ * from the first by xor with a hash of the fingerprint, so entries can be
+ * moved between their buckets without the key. About 0.01% false
+ * positives.
+ */
+struct CuckooFilter
+{
+  uint16_t* buckets;
+  size_t bucket_count;
+  size_t load;
+  uint64_t seed;
+  uint64_t rng;
+  uint16_t victim;
+  size_t victim_idx;
+};
+
+/*
+ * Sizes the filter to hold expected_n keys, rounded up to a power of two
+ * number of buckets.
+ */
+struct CuckooFilter*
+CuckooFilter_new(size_t expected_n);
+
+/*
+ * Same as CuckooFilter_new, with the seed passed to wyhash. Filters with
+ * different seeds give the same keys different fingerprints and buckets.
+ */
+struct CuckooFilter*
+CuckooFilter_new_with_seed(size_t expected_n, uint64_t seed);
+
+void
+CuckooFilter_free(struct CuckooFilter* f);
+
+/*
+ * Adds the key and returns 1. Returns 0 when the filter is full, either
+ * without adding the key or, on the add that fills it, with one fingerprint
+ * held aside until a delete frees room. Adding a key twice stores it twice,
+ * and it then takes two deletes to remove.
+ */
+int
+CuckooFilter_add(struct CuckooFilter* f, char* key, size_t key_len);
+
+/*
+ * Returns 0 when the key is not in the filter, and 1 when it probably is.
+ */
+int
+CuckooFilter_has(struct CuckooFilter* f, char* key, size_t key_len);
+
+/*
+ * Removes one copy of the key. Only keys that were added may be deleted,
+ * otherwise a key sharing its fingerprint can be removed instead.
+ */
+void
+CuckooFilter_delete(struct CuckooFilter* f, char* key, size_t key_len);
+
+#endif /* CUCKOO_FILTER_H */
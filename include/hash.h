@@ -20,8 +20,13 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#define FNV_OFFSET 14695981039346656037u;
-#define FNV_PRIME 1099511628211u;
+#define FNV_OFFSET 14695981039346656037u
+#define FNV_PRIME 1099511628211u
+
+/*
+ * Seeded 64 bit hash function over a byte string.
+ */
+typedef uint64_t (*HashFunction)(char* data, size_t data_len, uint64_t seed);
 
 /*
  * 64 bit FNV-1a hash function.
@@ -32,4 +37,88 @@
 uint64_t
 fnv_1a_hash(char* data, size_t data_len);
 
+/*
+ * 64 bit FNV-1a hash function with the offset basis perturbed by a seed.
+ *
+ * A seed of 0 gives the same result as fnv_1a_hash.
+ */
+uint64_t
+fnv_1a_hash_seeded(char* data, size_t data_len, uint64_t seed);
+
+/*
+ * 64 bit wyhash (final version 4) hash function.
+ *
+ * Consumes 16 or 48 bytes per round using unaligned 64 bit loads and a
+ * 64x64->128 bit multiply, with a branch-light path for keys up to 16 bytes.
+ *
+ * Reference:
+ * https://github.com/wangyi-fudan/wyhash
+ */
+uint64_t
+wyhash(char* data, size_t data_len, uint64_t seed);
+
+/*
+ * CRC-32C (Castagnoli) of data, continuing from the crc of earlier data, or
+ * 0 to start. Uses the SSE4.2 crc32 instruction when the CPU has it, picked
+ * at runtime, and a table otherwise.
+ */
+uint32_t
+crc32c(char* data, size_t data_len, uint32_t crc);
+
+/*
+ * 64 bit hash from the CRC-32C of the data, seeded with both halves of the
+ * seed folded together. The CRC and length are mixed over all 64 bits, but
+ * keys of one length only get 32 bits of entropy, and collisions are easy to
+ * construct. Fast for indexing tables, but prefer wyhash for untrusted keys.
+ */
+uint64_t
+crc32c_hash(char* data, size_t data_len, uint64_t seed);
+
+/*
+ * Hashes n keys into out, the same as calling hash on each. FNV-1a keys are
+ * hashed four at a time to hide its multiply latency, other functions hash
+ * one key after another.
+ */
+void
+hash_many(HashFunction hash,
+          uint64_t seed,
+          char** keys,
+          size_t* key_lens,
+          size_t n,
+          uint64_t* out);
+
+/*
+ * Incremental hash over data that arrives in pieces, such as the fields of
+ * a composite key. Hashing the pieces in order gives the same result as the
+ * one-shot function over their concatenation. wyhash keeps the current
+ * 48 byte block and the last 16 bytes of the previous one.
+ */
+struct HashState
+{
+  HashFunction hash;
+  uint64_t seed;
+  uint64_t see1;
+  uint64_t see2;
+  size_t len;
+  uint8_t buffer[64];
+  size_t buffer_len;
+};
+
+/*
+ * Starts a hash with the given function and seed. The function must be
+ * fnv_1a_hash_seeded, wyhash or crc32c_hash.
+ */
+void
+Hash_init(struct HashState* state, HashFunction hash, uint64_t seed);
+
+void
+Hash_update(struct HashState* state, char* data, size_t data_len);
+
+/*
+ * Returns the hash of everything added so far. The state is left as is, so
+ * more data can still be added.
+ */
+uint64_t
+Hash_final(const struct HashState* state);
+
 #endif /* HASH_H */
\ No newline at end of file
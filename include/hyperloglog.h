@@ -0,0 +1,119 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include "hash.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define HYPERLOGLOG_MIN_PRECISION 4
+#define HYPERLOGLOG_MAX_PRECISION 18
+
+/*
+ * Distinct count estimator. Each key's 64-bit hash picks one of 2^precision
+ * registers with its top bits, and the register keeps the longest run of
+ * leading zeros seen in the remaining bits. The standard error is about
+ * 1.04 / sqrt(2^precision), 0.8% in 16 KiB at precision 14.
+ *
+ * Small counts are kept sparse, as a sorted array of register index and
+ * value pairs, and switch to one byte per register once that would take
+ * more space.
+ */
+struct HyperLogLog
+{
+  uint8_t* registers;
+  uint32_t* sparse;
+  size_t sparse_len;
+  size_t sparse_capacity;
+  unsigned int precision;
+  HashFunction hash;
+  uint64_t seed;
+};
+
+struct HyperLogLog*
+HyperLogLog_new(unsigned int precision);
+
+struct HyperLogLog*
+HyperLogLog_new_with_hash(unsigned int precision,
+                          HashFunction hash,
+                          uint64_t seed);
+
+void
+HyperLogLog_free(struct HyperLogLog* h);
+
+void
+HyperLogLog_add(struct HyperLogLog* h, char* key, size_t key_len);
+
+/*
+ * Adds a key by a hash already computed with the estimator's hash function
+ * and seed.
+ */
+void
+HyperLogLog_add_hash(struct HyperLogLog* h, uint64_t hash);
+
+void
+HyperLogLog_add_keys(struct HyperLogLog* h,
+                     char** keys,
+                     size_t* key_lens,
+                     size_t n);
+
+/*
+ * Adds every remaining key of the iterator. The hashes cached in the set
+ * are used when it hashes the same way as the estimator.
+ */
+void
+HyperLogLog_add_iterator(struct HyperLogLog* h, struct SetIterator* iterator);
+
+/*
+ * Estimated number of distinct keys added.
+ */
+size_t
+HyperLogLog_estimate(struct HyperLogLog* h);
+
+/*
+ * Adds the keys counted by src to dst, for combining estimators filled on
+ * different threads. Both need the same precision, hash function and seed.
+ */
+void
+HyperLogLog_merge(struct HyperLogLog* dst, struct HyperLogLog* src);
+
+/*
+ * Size in bytes of the serialized form of the estimator.
+ */
+size_t
+HyperLogLog_serialized_size(struct HyperLogLog* h);
+
+/*
+ * Writes HyperLogLog_serialized_size bytes to data. The format is the same
+ * on every platform.
+ */
+void
+HyperLogLog_serialize(struct HyperLogLog* h, uint8_t* data);
+
+/*
+ * Reads an estimator written by HyperLogLog_serialize, or returns NULL when
+ * the data is not valid. The hash function is not stored and must be given
+ * again.
+ */
+struct HyperLogLog*
+HyperLogLog_deserialize(const uint8_t* data,
+                        size_t data_len,
+                        HashFunction hash);
+
+#endif /* HYPERLOGLOG_H */
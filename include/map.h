@@ -0,0 +1,91 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAP_H
+#define MAP_H
+
+#include "hash.h"
+#include "set.h"
+#include <stddef.h>
+
+/*
+ * Key to value map built on a Set with SET_VALUES. Each value sits in its
+ * key's slot right after the SetItem, so a lookup reads it from the slot it
+ * matched on. Values are owned by the caller and are not freed by the map.
+ */
+struct Map
+{
+  struct Set* set;
+};
+
+struct Map*
+Map_new(size_t inital_capacity);
+
+struct Map*
+Map_new_with_options(size_t inital_capacity,
+                     unsigned int flags,
+                     HashFunction hash,
+                     uint64_t seed);
+
+void
+Map_free(struct Map* m);
+
+/*
+ * Returns the key's value, or NULL when the key is missing.
+ */
+void*
+Map_get(struct Map* m, char* key, size_t key_len);
+
+/*
+ * Sets the key's value, adding the key if missing, and returns the slot
+ * holding the key.
+ */
+struct SetItem*
+Map_put(struct Map* m, char* key, size_t key_len, void* value);
+
+/*
+ * Returns the key's value, adding the key with the given value first if it
+ * is missing.
+ */
+void*
+Map_get_or_insert(struct Map* m, char* key, size_t key_len, void* value);
+
+/*
+ * Removes the key and returns its value, or NULL when the key is missing.
+ */
+void*
+Map_delete(struct Map* m, char* key, size_t key_len);
+
+struct MapIterator
+{
+  struct SetIterator* iterator;
+  void* value;
+};
+
+struct MapIterator*
+MapIterator_new(struct Map* m);
+
+void
+MapIterator_free(struct MapIterator* iterator);
+
+/*
+ * Returns the next entry's key in a SetItem, with its value in
+ * iterator->value, or NULL once every entry has been visited.
+ */
+struct SetItem*
+MapIterator_next(struct MapIterator* iterator);
+
+#endif /* MAP_H */
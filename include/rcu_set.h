@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RCU_SET_H
+#define RCU_SET_H
+
+#include "set.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Epoch a reader entered at, or 0 while it is outside the set. Padded to a
+ * cache line so readers only ever write to their own line.
+ */
+struct RcuSetReader
+{
+  _Alignas(64) _Atomic uint64_t epoch;
+};
+
+/*
+ * Set replaced by a writer, freed once no reader can still be using it.
+ */
+struct RcuSetRetired
+{
+  struct Set* set;
+  uint64_t epoch;
+  struct RcuSetRetired* next;
+};
+
+/*
+ * Read-mostly set. Readers look keys up in an immutable Set without locks
+ * or atomic read-modify-write operations, so they never wait on a writer.
+ * Writers serialize on a mutex, build a modified copy and publish it with
+ * a pointer swap. Replaced sets are freed once every reader that could have
+ * seen them has left, tracked with one epoch slot per reader.
+ */
+struct RcuSet
+{
+  _Atomic(struct Set*) current;
+  _Atomic uint64_t epoch;
+  struct RcuSetReader* readers;
+  size_t reader_count;
+  pthread_mutex_t writer;
+  struct RcuSetRetired* retired;
+};
+
+/*
+ * Creates a set for up to reader_count concurrent readers. Each reader
+ * passes its own index in [0, reader_count) to RcuSet_has. The set is
+ * created with Set_new_with_options, except SET_INCREMENTAL_RESIZE, which
+ * changes the table on lookups and is ignored when passed.
+ */
+struct RcuSet*
+RcuSet_new(size_t inital_capacity,
+           size_t reader_count,
+           unsigned int flags,
+           HashFunction hash,
+           uint64_t seed);
+
+/*
+ * Frees the set. No reader or writer may be using it.
+ */
+void
+RcuSet_free(struct RcuSet* s);
+
+int
+RcuSet_has(struct RcuSet* s, size_t reader, char* key, size_t key_len);
+
+/*
+ * Writers copy the whole set, so each update costs time linear in its size.
+ * Batch changes into one Set and publish it with RcuSet_replace.
+ */
+void
+RcuSet_put(struct RcuSet* s, char* key, size_t key_len);
+
+void
+RcuSet_delete(struct RcuSet* s, char* key, size_t key_len);
+
+/*
+ * Publishes next in place of the current set and takes ownership of it.
+ * A resize next has pending is finished first and SET_INCREMENTAL_RESIZE
+ * cleared from its options.
+ */
+void
+RcuSet_replace(struct RcuSet* s, struct Set* next);
+
+#endif /* RCU_SET_H */
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SEGMENTED_SET_H
+#define SEGMENTED_SET_H
+
+#include "hash.h"
+#include "set.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A Set and the lock that guards it, padded to a cache line so
+ * neighbouring locks do not contend. Which lock is used is up to the
+ * module that owns the segments.
+ */
+struct SegmentedSetSegment
+{
+  _Alignas(64) union
+  {
+    pthread_rwlock_t rwlock;
+    pthread_mutex_t mutex;
+  } lock;
+  struct Set* set;
+};
+
+/*
+ * Sets split into segments by the top bits of each key's hash. This holds
+ * the allocation and routing shared by ConcurrentSet and ShardedSet, which
+ * only differ in how they lock a segment.
+ */
+struct SegmentedSet
+{
+  struct SegmentedSetSegment* segments;
+  size_t segment_count;
+  unsigned int segment_bits;
+  HashFunction hash;
+  uint64_t seed;
+};
+
+/*
+ * Creates the segment Sets with the given options, splitting the capacity
+ * between them. The segment count is rounded up to a power of two. Locks
+ * are left for the caller to initialise.
+ */
+void
+SegmentedSet_init(struct SegmentedSet* s,
+                  size_t inital_capacity,
+                  size_t segment_count,
+                  unsigned int flags,
+                  HashFunction hash,
+                  uint64_t seed);
+
+/*
+ * Frees the segment Sets. Locks must already be destroyed.
+ */
+void
+SegmentedSet_destroy(struct SegmentedSet* s);
+
+/*
+ * Segment that owns the hash. The top bits pick the segment and the set
+ * inside uses the rest of the hash.
+ */
+static inline struct SegmentedSetSegment*
+SegmentedSet_segment(struct SegmentedSet* s, uint64_t hash)
+{
+  if (s->segment_bits == 0) {
+    return &s->segments[0];
+  }
+
+  return &s->segments[hash >> (64 - s->segment_bits)];
+}
+
+#endif /* SEGMENTED_SET_H */
@@ -17,42 +17,270 @@
 #ifndef SET_H
 #define SET_H
 
+#include "arena.h"
+#include "hash.h"
 #include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Rounds the capacity up to a power of two and maps hashes to slots with a
+ * Fibonacci multiply and shift instead of a modulo.
+ */
+#define SET_POW2_CAPACITY 0x1u
+
+/*
+ * SwissTable style open addressing. A separate array of one byte control
+ * tags (7 bits of hash, or an empty/deleted marker) is probed 16 slots at a
+ * time, and the item table is only read on a tag match. Implies
+ * SET_POW2_CAPACITY with a minimum capacity of 16.
+ */
+#define SET_SWISS_TABLE 0x2u
+
+/*
+ * Robin Hood linear probing. Each slot stores its probe distance, inserts
+ * take slots from entries closer to their home, and lookups stop as soon as
+ * they pass where the key would have been. Expands at 0.9 load instead of
+ * 0.75. Cannot be combined with SET_SWISS_TABLE.
+ */
+#define SET_ROBIN_HOOD 0x4u
+
+/*
+ * Keys up to this many bytes are stored inline in their SetItem, and key
+ * points into the slot. Longer keys are copied once and keep their address
+ * until they are deleted. Sized so a SetItem stays 48 bytes.
+ */
+#define SET_INLINE_KEY_LEN 20
+
+/*
+ * Copies keys that do not fit inline into large chunks owned by the set
+ * instead of one malloc per key. Deleted keys are not reclaimed until
+ * Set_free, which releases the chunks without visiting each key.
+ */
+#define SET_ARENA_KEYS 0x8u
+
+/*
+ * Spreads each resize over later operations. The old table is kept next to
+ * the new one, every Set_put, Set_has and Set_delete moves the entries of a
+ * bounded number of old slots across, and lookups check both tables until
+ * the move is done.
+ */
+#define SET_INCREMENTAL_RESIZE 0x10u
+
+/*
+ * Stores a void* value in each slot right after its SetItem, so a lookup
+ * reads the key and value from the same cache line. Used by Map, sets
+ * without it keep 48 byte slots.
+ */
+#define SET_VALUES 0x20u
 
 struct SetItem
 {
   char* key;
   size_t key_len;
+  uint64_t hash;
+  uint32_t dist;
+  char inline_key[SET_INLINE_KEY_LEN];
 };
 
+/*
+ * Slot layout of a set with SET_VALUES.
+ */
+struct SetValueItem
+{
+  struct SetItem item;
+  void* value;
+};
+
+/*
+ * table holds capacity slots of item_size bytes, each starting with a
+ * SetItem.
+ */
 struct Set
 {
   size_t capacity;
   size_t load;
   struct SetItem* table;
+  size_t item_size;
+  uint8_t* ctrl;
+  size_t deleted;
+  struct Arena* arena;
+  struct Set* resize_from;
+  size_t resize_idx;
+  HashFunction hash;
+  uint64_t seed;
+  unsigned int flags;
+  unsigned int shift;
 };
 
 struct Set*
 Set_new(size_t inital_capacity);
 
+struct Set*
+Set_new_with_hash(size_t inital_capacity, HashFunction hash, uint64_t seed);
+
+struct Set*
+Set_new_with_options(size_t inital_capacity,
+                     unsigned int flags,
+                     HashFunction hash,
+                     uint64_t seed);
+
 void
 Set_free(struct Set* s);
 
 int
 Set_has(struct Set* s, char* key, size_t key_len);
 
-void
+/*
+ * Set_has with a hash already computed by the set's hash function and seed.
+ */
+int
+Set_has_hashed(struct Set* s, char* key, size_t key_len, uint64_t hash);
+
+/*
+ * Returns the slot holding the key, or NULL. The slot is only valid until
+ * the set is next modified.
+ */
+struct SetItem*
+Set_get(struct Set* s, char* key, size_t key_len);
+
+/*
+ * Adds the key if missing and returns its slot. With SET_VALUES, a new key's
+ * value is NULL.
+ */
+struct SetItem*
 Set_put(struct Set* s, char* key, size_t key_len);
 
+/*
+ * Adds the key if missing and returns its slot, setting inserted to whether
+ * the key was added. Hashes the key and walks its probe sequence once.
+ */
+struct SetItem*
+Set_insert_or_find(struct Set* s, char* key, size_t key_len, int* inserted);
+
+/*
+ * Set_insert_or_find with a hash already computed by the set's hash function
+ * and seed, for callers that hash keys ahead of time.
+ */
+struct SetItem*
+Set_insert_or_find_hashed(struct Set* s,
+                          char* key,
+                          size_t key_len,
+                          uint64_t hash,
+                          int* inserted);
+
+/*
+ * Set_has for n keys, writing 1 or 0 to results for each. Keys are hashed
+ * and their slots prefetched a group at a time before any are probed, which
+ * hides memory latency on tables that do not fit in cache.
+ */
+void
+Set_has_batch(struct Set* s,
+              char** keys,
+              size_t* key_lens,
+              size_t n,
+              int* results);
+
+/*
+ * Set_put for n keys, prefetching like Set_has_batch. Returns the number of
+ * keys that were not already in the set.
+ */
+size_t
+Set_put_batch(struct Set* s, char** keys, size_t* key_lens, size_t n);
+
 void
 Set_delete(struct Set* s, char* key, size_t key_len);
 
+/*
+ * Set_delete with a hash already computed by the set's hash function and
+ * seed.
+ */
+void
+Set_delete_hashed(struct Set* s, char* key, size_t key_len, uint64_t hash);
+
+/*
+ * Removes the key and returns its value, probing once. Returns NULL when the
+ * key is missing. The set must have SET_VALUES.
+ */
+void*
+Set_delete_value(struct Set* s, char* key, size_t key_len);
+
+/*
+ * Returns the value slot of an item returned by Set_get, Set_put or
+ * Set_insert_or_find, valid as long as the item is. The set must have
+ * SET_VALUES.
+ */
+void**
+Set_value(struct Set* s, struct SetItem* item);
+
+/*
+ * Moves every entry left in the old table of a resize spread out by
+ * SET_INCREMENTAL_RESIZE, so the set no longer changes on lookups.
+ */
+void
+Set_finish_resize(struct Set* s);
+
+/*
+ * Returns a copy of the set with the same options, capacity and layout.
+ */
+struct Set*
+Set_copy(struct Set* s);
+
+/*
+ * The set algebra functions return a new set with the options of s_a, sized
+ * from the loads of their inputs. Values are taken from s_a where a key is
+ * in both, and cached hashes are reused when the sets hash the same way.
+ */
 struct Set*
 Set_union(struct Set* s_a, struct Set* s_b);
 
 struct Set*
 Set_intersection(struct Set* s_a, struct Set* s_b);
 
+/*
+ * Keys of s_a that are not in s_b.
+ */
+struct Set*
+Set_difference(struct Set* s_a, struct Set* s_b);
+
+/*
+ * Keys in exactly one of s_a and s_b.
+ */
+struct Set*
+Set_symmetric_difference(struct Set* s_a, struct Set* s_b);
+
+/*
+ * Returns 1 when every key of s_a is in s_b, otherwise 0.
+ */
+int
+Set_is_subset(struct Set* s_a, struct Set* s_b);
+
+/*
+ * Adds the keys of s_b to s_a, growing s_a at most once.
+ */
+void
+Set_union_in_place(struct Set* s_a, struct Set* s_b);
+
+/*
+ * Moves the keys of s_b into s_a and frees s_b. Key storage is handed over
+ * rather than copied when both or neither set use SET_ARENA_KEYS.
+ */
+void
+Set_union_consume(struct Set* s_a, struct Set* s_b);
+
+/*
+ * Set_intersection and Set_union using up to the given number of
+ * threads, capped at the number of online CPUs. The result table is split
+ * into parts by where each key's probe sequence starts. The inputs are
+ * scanned in chunks that sort their keys by part, and then each part is
+ * filled by one thread. No other thread may use either input while they
+ * run.
+ */
+struct Set*
+Set_intersection_parallel(struct Set* s_a, struct Set* s_b, size_t threads);
+
+struct Set*
+Set_union_parallel(struct Set* s_a, struct Set* s_b, size_t threads);
+
 struct SetIterator
 {
   struct Set* set;
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SHARDED_SET_H
+#define SHARDED_SET_H
+
+#include "hash.h"
+#include "segmented_set.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Set split into independent shards by the top bits of each key's hash.
+ * Every shard resizes on its own, so a resize only moves the keys of one
+ * shard, and writers to different shards do not wait for each other.
+ * Shards are guarded by plain mutexes, so they take any Set options.
+ */
+struct ShardedSet
+{
+  struct SegmentedSet base;
+};
+
+struct ShardedSet*
+ShardedSet_new(size_t inital_capacity, size_t shard_count);
+
+/*
+ * Shards are created with the given Set options. The shard count is
+ * rounded up to a power of two.
+ */
+struct ShardedSet*
+ShardedSet_new_with_options(size_t inital_capacity,
+                            size_t shard_count,
+                            unsigned int flags,
+                            HashFunction hash,
+                            uint64_t seed);
+
+void
+ShardedSet_free(struct ShardedSet* s);
+
+int
+ShardedSet_has(struct ShardedSet* s, char* key, size_t key_len);
+
+/*
+ * Adds the key if missing. Returns 1 when it was added, otherwise 0.
+ */
+int
+ShardedSet_put(struct ShardedSet* s, char* key, size_t key_len);
+
+void
+ShardedSet_delete(struct ShardedSet* s, char* key, size_t key_len);
+
+/*
+ * Number of keys, counted one shard at a time.
+ */
+size_t
+ShardedSet_load(struct ShardedSet* s);
+
+#endif /* SHARDED_SET_H */
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include "count_min_sketch.h"
+#include "map.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A tracked heavy hitter, with count the sketch's estimate when the key was
+ * last added. The key points at the TopK's Map copy, except keys short
+ * enough for the Map to store inline in its slots, which move, and are kept
+ * in inline_key instead.
+ */
+struct TopKItem
+{
+  char* key;
+  size_t key_len;
+  uint32_t count;
+  size_t index;
+  char inline_key[SET_INLINE_KEY_LEN];
+};
+
+/*
+ * Heavy hitters over a stream. Every key is counted in a CountMinSketch,
+ * and the k keys with the largest estimates are kept in a min-heap, with a
+ * Map from key to heap item. A key enters the heap once its estimate beats
+ * the smallest tracked count, which evicts that item.
+ */
+struct TopK
+{
+  struct CountMinSketch* sketch;
+  struct Map* items;
+  struct TopKItem** heap;
+  size_t len;
+  size_t k;
+};
+
+/*
+ * Tracks k keys, counted by a sketch made with CountMinSketch_new(epsilon,
+ * delta). With a k of 0 keys are still counted, but none are tracked.
+ */
+struct TopK*
+TopK_new(size_t k, double epsilon, double delta);
+
+void
+TopK_free(struct TopK* t);
+
+/*
+ * Adds count occurrences of the key and returns its new estimate.
+ */
+uint32_t
+TopK_add(struct TopK* t, char* key, size_t key_len, uint32_t count);
+
+/*
+ * Writes the tracked items to out, largest count first, and returns how
+ * many were written. out must have room for k items. The items stay owned
+ * by the TopK and are only valid until the next add.
+ */
+size_t
+TopK_list(struct TopK* t, struct TopKItem** out);
+
+#endif /* TOP_K_H */
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef U64_SET_H
+#define U64_SET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Set of 64-bit integers stored directly in an open addressed table of
+ * 8-byte slots. 0 marks an empty slot, so the key 0 is tracked on its own
+ * in has_zero. Keys are placed with a Fibonacci multiply and shift into a
+ * power-of-two table and probed linearly.
+ */
+struct U64Set
+{
+  uint64_t* table;
+  size_t capacity;
+  size_t load;
+  int has_zero;
+  unsigned int shift;
+};
+
+struct U64Set*
+U64Set_new(size_t inital_capacity);
+
+void
+U64Set_free(struct U64Set* s);
+
+int
+U64Set_has(struct U64Set* s, uint64_t key);
+
+/*
+ * Adds the key if missing. Returns 1 when it was added, otherwise 0.
+ */
+int
+U64Set_put(struct U64Set* s, uint64_t key);
+
+void
+U64Set_delete(struct U64Set* s, uint64_t key);
+
+struct U64SetIterator
+{
+  struct U64Set* set;
+  size_t idx;
+  int zero_done;
+};
+
+struct U64SetIterator*
+U64SetIterator_new(struct U64Set* s);
+
+void
+U64SetIterator_free(struct U64SetIterator* iterator);
+
+/*
+ * Writes the next key to key and returns 1, or returns 0 once every key has
+ * been visited.
+ */
+int
+U64SetIterator_next(struct U64SetIterator* iterator, uint64_t* key);
+
+#endif /* U64_SET_H */
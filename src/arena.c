@@ -0,0 +1,99 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "arena.h"
+#include <assert.h>
+#include <stdlib.h>
+
+static struct ArenaChunk*
+_ArenaChunk_new(size_t capacity)
+{
+  struct ArenaChunk* chunk = malloc(sizeof(struct ArenaChunk) + capacity);
+
+  chunk->next = NULL;
+  chunk->capacity = capacity;
+  chunk->length = 0;
+
+  return chunk;
+}
+
+struct Arena*
+Arena_new(size_t chunk_size)
+{
+  assert(chunk_size > 0);
+
+  struct Arena* a = malloc(sizeof(struct Arena));
+
+  a->chunk = NULL;
+  a->chunk_size = chunk_size;
+
+  return a;
+}
+
+void
+Arena_free(struct Arena* a)
+{
+  struct ArenaChunk* chunk = a->chunk;
+  while (chunk != NULL) {
+    struct ArenaChunk* next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+
+  free(a);
+}
+
+void*
+Arena_alloc(struct Arena* a, size_t size)
+{
+  struct ArenaChunk* chunk = a->chunk;
+  if (chunk != NULL && chunk->capacity - chunk->length >= size) {
+    void* data = &chunk->data[chunk->length];
+    chunk->length += size;
+
+    return data;
+  }
+
+  // Oversized allocations get a chunk of their own behind the current one
+  if (size > a->chunk_size / 2 && chunk != NULL) {
+    struct ArenaChunk* large = _ArenaChunk_new(size);
+    large->length = size;
+    large->next = chunk->next;
+    chunk->next = large;
+
+    return large->data;
+  }
+
+  chunk = _ArenaChunk_new(size > a->chunk_size ? size : a->chunk_size);
+  chunk->length = size;
+  chunk->next = a->chunk;
+  a->chunk = chunk;
+
+  return chunk->data;
+}
+
+void
+Arena_merge(struct Arena* dst, struct Arena* src)
+{
+  // Append behind the current chunk so dst keeps filling it
+  struct ArenaChunk** tail = &dst->chunk;
+  while (*tail != NULL) {
+    tail = &(*tail)->next;
+  }
+  *tail = src->chunk;
+
+  free(src);
+}
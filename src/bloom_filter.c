@@ -0,0 +1,187 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bloom_filter.h"
+#include "constants.h"
+#include "hash.h"
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOOM_FILTER_MAX_HASHES 16
+
+// Bit positions are the top 9 bits of a 64-bit state that is stepped once
+// per probe, so each position depends on the whole hash. Deriving them from
+// 32-bit double hashing left about 18 bits per key, which put a floor near
+// keys_per_block / 2^18 under the false positive rate.
+#define BLOOM_FILTER_BIT_SHIFT 55
+
+static struct BloomFilter*
+_BloomFilter_alloc(size_t block_count, unsigned int hashes, uint64_t seed)
+{
+  struct BloomFilter* f = malloc(sizeof(struct BloomFilter));
+
+  f->blocks = aligned_alloc(64, block_count * BLOOM_FILTER_BLOCK_WORDS * 8);
+  memset(f->blocks, 0, block_count * BLOOM_FILTER_BLOCK_WORDS * 8);
+  f->block_count = block_count;
+  f->hashes = hashes;
+  f->seed = seed;
+
+  return f;
+}
+
+static unsigned int
+_BloomFilter_hashes(double bits_per_key)
+{
+  double hashes = round(bits_per_key * LN_2);
+
+  if (hashes < 1) {
+    return 1;
+  } else if (hashes > BLOOM_FILTER_MAX_HASHES) {
+    return BLOOM_FILTER_MAX_HASHES;
+  }
+  return (unsigned int)hashes;
+}
+
+/*
+ * False positive rate of a blocked filter. Block loads are Poisson with a
+ * mean of BLOOM_FILTER_BLOCK_BITS / bits_per_key keys, and each load is
+ * weighted by the rate of an unblocked filter of one block.
+ */
+static double
+_BloomFilter_blocked_rate(double bits_per_key, unsigned int hashes)
+{
+  double mean = BLOOM_FILTER_BLOCK_BITS / bits_per_key;
+  double p = exp(-mean);
+  double rate = 0;
+
+  for (unsigned int load = 0; load < mean * 4 + 64; load++) {
+    double bit_unset = pow(1 - 1.0 / BLOOM_FILTER_BLOCK_BITS, hashes * load);
+    rate += p * pow(1 - bit_unset, hashes);
+    p *= mean / (load + 1);
+  }
+
+  return rate;
+}
+
+struct BloomFilter*
+BloomFilter_new(size_t expected_n, double fp_rate)
+{
+  return BloomFilter_new_with_seed(expected_n, fp_rate, 0);
+}
+
+struct BloomFilter*
+BloomFilter_new_with_seed(size_t expected_n, double fp_rate, uint64_t seed)
+{
+  assert(fp_rate > 0 && fp_rate < 1);
+
+  if (expected_n == 0) {
+    expected_n = 1;
+  }
+
+  // Start from the unblocked optimum, -ln(p) / ln(2)^2 bits per key, and
+  // add bits until uneven block loads no longer push the rate over fp_rate
+  double bits_per_key = -log(fp_rate) / (LN_2 * LN_2);
+  while (_BloomFilter_blocked_rate(
+           bits_per_key, _BloomFilter_hashes(bits_per_key)) > fp_rate) {
+    bits_per_key *= 1.05;
+  }
+
+  double bits = bits_per_key * (double)expected_n;
+  size_t block_count = (size_t)ceil(bits / BLOOM_FILTER_BLOCK_BITS);
+
+  return _BloomFilter_alloc(
+    block_count, _BloomFilter_hashes(bits_per_key), seed);
+}
+
+void
+BloomFilter_free(struct BloomFilter* f)
+{
+  free(f->blocks);
+  free(f);
+}
+
+/*
+ * Picks the key's block from the top 32 bits of the hash, without a
+ * division.
+ */
+static inline uint64_t*
+_BloomFilter_block(const struct BloomFilter* f, uint64_t hash)
+{
+  size_t block = (size_t)(((hash >> 32) * f->block_count) >> 32);
+
+  return &f->blocks[block * BLOOM_FILTER_BLOCK_WORDS];
+}
+
+/*
+ * Steps the probe state with a 64-bit LCG. The Fibonacci multiplier is 1 mod
+ * 4 and the increment odd, so the state runs through every value, and the
+ * multiply carries every bit of it into the top bits.
+ */
+static inline uint64_t
+_BloomFilter_next(uint64_t state)
+{
+  return state * FIBONACCI_MULTIPLIER + 1;
+}
+
+void
+BloomFilter_add(struct BloomFilter* f, char* key, size_t key_len)
+{
+  uint64_t state = wyhash(key, key_len, f->seed);
+  uint64_t* block = _BloomFilter_block(f, state);
+
+  for (unsigned int i = 0; i < f->hashes; i++) {
+    state = _BloomFilter_next(state);
+    unsigned int bit = (unsigned int)(state >> BLOOM_FILTER_BIT_SHIFT);
+    block[bit / 64] |= (uint64_t)1 << (bit % 64);
+  }
+}
+
+int
+BloomFilter_maybe_has(struct BloomFilter* f, char* key, size_t key_len)
+{
+  uint64_t state = wyhash(key, key_len, f->seed);
+  uint64_t* block = _BloomFilter_block(f, state);
+
+  // Test every bit rather than stopping early, the line is already loaded
+  uint64_t missing = 0;
+  for (unsigned int i = 0; i < f->hashes; i++) {
+    state = _BloomFilter_next(state);
+    unsigned int bit = (unsigned int)(state >> BLOOM_FILTER_BIT_SHIFT);
+    missing |= ~block[bit / 64] & ((uint64_t)1 << (bit % 64));
+  }
+
+  return missing == 0;
+}
+
+struct BloomFilter*
+BloomFilter_union(struct BloomFilter* f_a, struct BloomFilter* f_b)
+{
+  assert(f_a->block_count == f_b->block_count);
+  assert(f_a->hashes == f_b->hashes && f_a->seed == f_b->seed);
+
+  struct BloomFilter* f =
+    _BloomFilter_alloc(f_a->block_count, f_a->hashes, f_a->seed);
+
+  for (size_t i = 0; i < f->block_count * BLOOM_FILTER_BLOCK_WORDS; i++) {
+    f->blocks[i] = f_a->blocks[i] | f_b->blocks[i];
+  }
+
+  return f;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "concurrent_set.h"
+#include "hash.h"
+#include "segmented_set.h"
+#include "set.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct ConcurrentSet*
+ConcurrentSet_new(size_t inital_capacity, size_t segment_count)
+{
+  return ConcurrentSet_new_with_options(
+    inital_capacity, segment_count, 0, wyhash, 0);
+}
+
+struct ConcurrentSet*
+ConcurrentSet_new_with_options(size_t inital_capacity,
+                               size_t segment_count,
+                               unsigned int flags,
+                               HashFunction hash,
+                               uint64_t seed)
+{
+  // Dropped rather than asserted on, so release builds never hand lookups
+  // under a read lock a set they could modify
+  flags &= ~SET_INCREMENTAL_RESIZE;
+
+  struct ConcurrentSet* s = malloc(sizeof(struct ConcurrentSet));
+
+  SegmentedSet_init(
+    &s->base, inital_capacity, segment_count, flags, hash, seed);
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    pthread_rwlock_init(&s->base.segments[i].lock.rwlock, NULL);
+  }
+
+  return s;
+}
+
+void
+ConcurrentSet_free(struct ConcurrentSet* s)
+{
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    pthread_rwlock_destroy(&s->base.segments[i].lock.rwlock);
+  }
+
+  SegmentedSet_destroy(&s->base);
+  free(s);
+}
+
+int
+ConcurrentSet_has(struct ConcurrentSet* s, char* key, size_t key_len)
+{
+  uint64_t hash = s->base.hash(key, key_len, s->base.seed);
+  struct SegmentedSetSegment* segment = SegmentedSet_segment(&s->base, hash);
+
+  pthread_rwlock_rdlock(&segment->lock.rwlock);
+  int res = Set_has_hashed(segment->set, key, key_len, hash);
+  pthread_rwlock_unlock(&segment->lock.rwlock);
+
+  return res;
+}
+
+int
+ConcurrentSet_put(struct ConcurrentSet* s, char* key, size_t key_len)
+{
+  uint64_t hash = s->base.hash(key, key_len, s->base.seed);
+  struct SegmentedSetSegment* segment = SegmentedSet_segment(&s->base, hash);
+
+  int inserted;
+  pthread_rwlock_wrlock(&segment->lock.rwlock);
+  Set_insert_or_find_hashed(segment->set, key, key_len, hash, &inserted);
+  pthread_rwlock_unlock(&segment->lock.rwlock);
+
+  return inserted;
+}
+
+void
+ConcurrentSet_delete(struct ConcurrentSet* s, char* key, size_t key_len)
+{
+  uint64_t hash = s->base.hash(key, key_len, s->base.seed);
+  struct SegmentedSetSegment* segment = SegmentedSet_segment(&s->base, hash);
+
+  pthread_rwlock_wrlock(&segment->lock.rwlock);
+  Set_delete_hashed(segment->set, key, key_len, hash);
+  pthread_rwlock_unlock(&segment->lock.rwlock);
+}
+
+size_t
+ConcurrentSet_load(struct ConcurrentSet* s)
+{
+  size_t load = 0;
+
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    struct SegmentedSetSegment* segment = &s->base.segments[i];
+    pthread_rwlock_rdlock(&segment->lock.rwlock);
+    load += segment->set->load;
+    pthread_rwlock_unlock(&segment->lock.rwlock);
+  }
+
+  return load;
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONSTANTS_H
+#define CONSTANTS_H
+
+// 2^64 divided by the golden ratio, for Fibonacci hashing
+#define FIBONACCI_MULTIPLIER 11400714819323198485u
+
+#define LN_2 0.69314718055994530942
+
+#endif /* CONSTANTS_H */
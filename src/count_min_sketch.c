@@ -0,0 +1,147 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "count_min_sketch.h"
+#include "hash.h"
+#include "mix.h"
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define E 2.71828182845904523536
+
+struct CountMinSketch*
+CountMinSketch_new(double epsilon, double delta)
+{
+  assert(epsilon > 0 && epsilon < 1);
+  assert(delta > 0 && delta < 1);
+
+  double depth = ceil(log(1 / delta));
+  if (depth > COUNT_MIN_SKETCH_MAX_DEPTH) {
+    depth = COUNT_MIN_SKETCH_MAX_DEPTH;
+  }
+
+  return CountMinSketch_new_with_size(
+    (size_t)ceil(E / epsilon), (unsigned int)depth, 0);
+}
+
+struct CountMinSketch*
+CountMinSketch_new_with_size(size_t width, unsigned int depth, uint64_t seed)
+{
+  assert(depth >= 1 && depth <= COUNT_MIN_SKETCH_MAX_DEPTH);
+
+  struct CountMinSketch* cms = malloc(sizeof(struct CountMinSketch));
+
+  cms->width = 1;
+  while (cms->width < width) {
+    cms->width <<= 1;
+  }
+  cms->depth = depth;
+  cms->counters = calloc(cms->width * depth, sizeof(uint32_t));
+  cms->seed = seed;
+  cms->total = 0;
+
+  return cms;
+}
+
+void
+CountMinSketch_free(struct CountMinSketch* cms)
+{
+  free(cms->counters);
+  free(cms);
+}
+
+/*
+ * Fills offsets with the key's counter in each row. FNV-1a leaves its low
+ * bits weakly mixed, so the hash is finalized before it is split into the
+ * start and odd step of the double hashing.
+ */
+static inline void
+_CountMinSketch_offsets(const struct CountMinSketch* cms,
+                        char* key,
+                        size_t key_len,
+                        size_t* offsets)
+{
+  uint64_t hash = mix64(fnv_1a_hash_seeded(key, key_len, cms->seed));
+
+  size_t mask = cms->width - 1;
+  uint64_t start = hash;
+  uint64_t step = (hash >> 32) | 1;
+
+  for (unsigned int i = 0; i < cms->depth; i++) {
+    offsets[i] = i * cms->width + ((start + i * step) & mask);
+  }
+}
+
+static inline uint32_t
+_CountMinSketch_min(const struct CountMinSketch* cms, const size_t* offsets)
+{
+  uint32_t estimate = UINT32_MAX;
+  for (unsigned int i = 0; i < cms->depth; i++) {
+    if (cms->counters[offsets[i]] < estimate) {
+      estimate = cms->counters[offsets[i]];
+    }
+  }
+
+  return estimate;
+}
+
+uint32_t
+CountMinSketch_add(struct CountMinSketch* cms,
+                   char* key,
+                   size_t key_len,
+                   uint32_t count)
+{
+  size_t offsets[COUNT_MIN_SKETCH_MAX_DEPTH];
+  _CountMinSketch_offsets(cms, key, key_len, offsets);
+
+  uint32_t estimate = _CountMinSketch_min(cms, offsets);
+  estimate = estimate > UINT32_MAX - count ? UINT32_MAX : estimate + count;
+  for (unsigned int i = 0; i < cms->depth; i++) {
+    if (cms->counters[offsets[i]] < estimate) {
+      cms->counters[offsets[i]] = estimate;
+    }
+  }
+  cms->total += count;
+
+  return estimate;
+}
+
+uint32_t
+CountMinSketch_estimate(struct CountMinSketch* cms, char* key, size_t key_len)
+{
+  size_t offsets[COUNT_MIN_SKETCH_MAX_DEPTH];
+  _CountMinSketch_offsets(cms, key, key_len, offsets);
+
+  return _CountMinSketch_min(cms, offsets);
+}
+
+void
+CountMinSketch_merge(struct CountMinSketch* dst, struct CountMinSketch* src)
+{
+  assert(dst->width == src->width && dst->depth == src->depth);
+  assert(dst->seed == src->seed);
+
+  for (size_t i = 0; i < dst->width * dst->depth; i++) {
+    uint32_t counter = dst->counters[i];
+    dst->counters[i] = counter > UINT32_MAX - src->counters[i]
+                         ? UINT32_MAX
+                         : counter + src->counters[i];
+  }
+  dst->total += src->total;
+}
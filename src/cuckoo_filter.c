@@ -0,0 +1,240 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cuckoo_filter.h"
+#include "constants.h"
+#include "hash.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define CUCKOO_FILTER_MAX_LOAD 0.95
+
+#define CUCKOO_FILTER_MAX_KICKS 500
+
+#define MURMUR_MULTIPLIER 0x5bd1e995u
+
+struct CuckooFilter*
+CuckooFilter_new(size_t expected_n)
+{
+  return CuckooFilter_new_with_seed(expected_n, 0);
+}
+
+struct CuckooFilter*
+CuckooFilter_new_with_seed(size_t expected_n, uint64_t seed)
+{
+  struct CuckooFilter* f = malloc(sizeof(struct CuckooFilter));
+
+  size_t bucket_count = 1;
+  while (bucket_count * CUCKOO_FILTER_BUCKET_SIZE * CUCKOO_FILTER_MAX_LOAD <
+         expected_n) {
+    bucket_count *= 2;
+  }
+
+  f->buckets =
+    calloc(bucket_count * CUCKOO_FILTER_BUCKET_SIZE, sizeof(uint16_t));
+  f->bucket_count = bucket_count;
+  f->load = 0;
+  f->seed = seed;
+  f->rng = FIBONACCI_MULTIPLIER;
+  f->victim = 0;
+  f->victim_idx = 0;
+
+  return f;
+}
+
+void
+CuckooFilter_free(struct CuckooFilter* f)
+{
+  free(f->buckets);
+  free(f);
+}
+
+/*
+ * Splits the key's hash into a fingerprint from the top 16 bits, never 0
+ * since 0 marks an empty slot, and its first bucket from the low bits.
+ */
+static inline uint16_t
+_CuckooFilter_fingerprint(const struct CuckooFilter* f,
+                          char* key,
+                          size_t key_len,
+                          size_t* idx)
+{
+  uint64_t hash = wyhash(key, key_len, f->seed);
+
+  *idx = (size_t)hash & (f->bucket_count - 1);
+
+  uint16_t fingerprint = (uint16_t)(hash >> 48);
+  return fingerprint != 0 ? fingerprint : 1;
+}
+
+/*
+ * The other bucket of a fingerprint. Applying it twice gives back the
+ * first bucket.
+ */
+static inline size_t
+_CuckooFilter_alt(const struct CuckooFilter* f,
+                  size_t idx,
+                  uint16_t fingerprint)
+{
+  return (idx ^ (fingerprint * MURMUR_MULTIPLIER)) & (f->bucket_count - 1);
+}
+
+static inline int
+_CuckooFilter_bucket_has(const struct CuckooFilter* f,
+                         size_t idx,
+                         uint16_t fingerprint)
+{
+  const uint16_t* bucket = &f->buckets[idx * CUCKOO_FILTER_BUCKET_SIZE];
+
+  return (bucket[0] == fingerprint) | (bucket[1] == fingerprint) |
+         (bucket[2] == fingerprint) | (bucket[3] == fingerprint);
+}
+
+static inline int
+_CuckooFilter_bucket_put(struct CuckooFilter* f,
+                         size_t idx,
+                         uint16_t fingerprint)
+{
+  uint16_t* bucket = &f->buckets[idx * CUCKOO_FILTER_BUCKET_SIZE];
+
+  for (size_t i = 0; i < CUCKOO_FILTER_BUCKET_SIZE; i++) {
+    if (bucket[i] == 0) {
+      bucket[i] = fingerprint;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static inline int
+_CuckooFilter_bucket_delete(struct CuckooFilter* f,
+                            size_t idx,
+                            uint16_t fingerprint)
+{
+  uint16_t* bucket = &f->buckets[idx * CUCKOO_FILTER_BUCKET_SIZE];
+
+  for (size_t i = 0; i < CUCKOO_FILTER_BUCKET_SIZE; i++) {
+    if (bucket[i] == fingerprint) {
+      bucket[i] = 0;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Places a fingerprint in its bucket at idx or its other bucket, evicting
+ * random entries to their other bucket when both are full. Returns 0 and
+ * holds the last homeless fingerprint as the victim when that fails.
+ */
+static int
+_CuckooFilter_insert(struct CuckooFilter* f, size_t idx, uint16_t fingerprint)
+{
+  if (_CuckooFilter_bucket_put(f, idx, fingerprint)) {
+    return 1;
+  }
+
+  idx = _CuckooFilter_alt(f, idx, fingerprint);
+  if (_CuckooFilter_bucket_put(f, idx, fingerprint)) {
+    return 1;
+  }
+
+  for (size_t kick = 0; kick < CUCKOO_FILTER_MAX_KICKS; kick++) {
+    f->rng ^= f->rng << 13;
+    f->rng ^= f->rng >> 7;
+    f->rng ^= f->rng << 17;
+
+    uint16_t* slot = &f->buckets[idx * CUCKOO_FILTER_BUCKET_SIZE +
+                                 f->rng % CUCKOO_FILTER_BUCKET_SIZE];
+    uint16_t evicted = *slot;
+    *slot = fingerprint;
+    fingerprint = evicted;
+
+    idx = _CuckooFilter_alt(f, idx, fingerprint);
+    if (_CuckooFilter_bucket_put(f, idx, fingerprint)) {
+      return 1;
+    }
+  }
+
+  // Keep the homeless fingerprint aside so no added key goes missing
+  f->victim = fingerprint;
+  f->victim_idx = idx;
+
+  return 0;
+}
+
+int
+CuckooFilter_add(struct CuckooFilter* f, char* key, size_t key_len)
+{
+  // A fingerprint left over from a failed add means the filter is full
+  if (f->victim != 0) {
+    return 0;
+  }
+
+  size_t idx;
+  uint16_t fingerprint = _CuckooFilter_fingerprint(f, key, key_len, &idx);
+
+  f->load += 1;
+
+  return _CuckooFilter_insert(f, idx, fingerprint);
+}
+
+int
+CuckooFilter_has(struct CuckooFilter* f, char* key, size_t key_len)
+{
+  size_t idx;
+  uint16_t fingerprint = _CuckooFilter_fingerprint(f, key, key_len, &idx);
+  size_t alt = _CuckooFilter_alt(f, idx, fingerprint);
+
+  if (f->victim == fingerprint &&
+      (f->victim_idx == idx || f->victim_idx == alt)) {
+    return 1;
+  }
+
+  return _CuckooFilter_bucket_has(f, idx, fingerprint) |
+         _CuckooFilter_bucket_has(f, alt, fingerprint);
+}
+
+void
+CuckooFilter_delete(struct CuckooFilter* f, char* key, size_t key_len)
+{
+  size_t idx;
+  uint16_t fingerprint = _CuckooFilter_fingerprint(f, key, key_len, &idx);
+  size_t alt = _CuckooFilter_alt(f, idx, fingerprint);
+
+  if (f->victim == fingerprint &&
+      (f->victim_idx == idx || f->victim_idx == alt)) {
+    f->victim = 0;
+    f->load -= 1;
+    return;
+  }
+
+  if (!_CuckooFilter_bucket_delete(f, idx, fingerprint) &&
+      !_CuckooFilter_bucket_delete(f, alt, fingerprint)) {
+    return;
+  }
+  f->load -= 1;
+
+  // Try to find the victim a place now there is a free slot
+  if (f->victim != 0) {
+    uint16_t victim = f->victim;
+    f->victim = 0;
+    _CuckooFilter_insert(f, f->victim_idx, victim);
+  }
+}
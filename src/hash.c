@@ -15,18 +15,494 @@
  */
 
 #include "hash.h"
+#include "mix.h"
 #include <assert.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define CRC32C_SSE42
+#endif
 
 uint64_t
 fnv_1a_hash(char* data, size_t data_len)
 {
   assert(data_len > 0);
 
-  uint64_t hash = FNV_OFFSET;
+  return fnv_1a_hash_seeded(data, data_len, 0);
+}
+
+uint64_t
+fnv_1a_hash_seeded(char* data, size_t data_len, uint64_t seed)
+{
+  uint64_t hash = FNV_OFFSET ^ seed;
   for (size_t i = 0; i < data_len; i++) {
     hash ^= data[i];
     hash *= FNV_PRIME;
   }
 
   return hash;
-}
\ No newline at end of file
+}
+
+// Keys hashed side by side by hash_many. Each FNV-1a key is a chain of
+// dependent multiplies, so four chains keep the multiplier busy where one
+// would wait on its latency.
+#define HASH_MANY_LANES 4
+
+/*
+ * Continues an FNV-1a hash over the bytes of data from done on.
+ */
+static inline uint64_t
+_fnv_1a_finish(uint64_t hash, char* data, size_t data_len, size_t done)
+{
+  for (size_t i = done; i < data_len; i++) {
+    hash ^= data[i];
+    hash *= FNV_PRIME;
+  }
+
+  return hash;
+}
+
+static inline size_t
+_hash_many_min_len(size_t* key_lens)
+{
+  size_t len = key_lens[0];
+  for (size_t i = 1; i < HASH_MANY_LANES; i++) {
+    if (key_lens[i] < len) {
+      len = key_lens[i];
+    }
+  }
+
+  return len;
+}
+
+/*
+ * Interleaves groups of keys over their common length, then finishes each
+ * key on its own. Returns how many keys were hashed, always a multiple of
+ * HASH_MANY_LANES.
+ */
+static size_t
+_fnv_1a_many(uint64_t seed,
+             char** keys,
+             size_t* key_lens,
+             size_t n,
+             uint64_t* out)
+{
+  size_t i = 0;
+  for (; i + HASH_MANY_LANES <= n; i += HASH_MANY_LANES) {
+    char** k = keys + i;
+    size_t len = _hash_many_min_len(key_lens + i);
+
+    uint64_t h0 = FNV_OFFSET ^ seed, h1 = h0, h2 = h0, h3 = h0;
+    for (size_t j = 0; j < len; j++) {
+      h0 = (h0 ^ k[0][j]) * FNV_PRIME;
+      h1 = (h1 ^ k[1][j]) * FNV_PRIME;
+      h2 = (h2 ^ k[2][j]) * FNV_PRIME;
+      h3 = (h3 ^ k[3][j]) * FNV_PRIME;
+    }
+
+    out[i] = _fnv_1a_finish(h0, k[0], key_lens[i], len);
+    out[i + 1] = _fnv_1a_finish(h1, k[1], key_lens[i + 1], len);
+    out[i + 2] = _fnv_1a_finish(h2, k[2], key_lens[i + 2], len);
+    out[i + 3] = _fnv_1a_finish(h3, k[3], key_lens[i + 3], len);
+  }
+
+  return i;
+}
+
+void
+hash_many(HashFunction hash,
+          uint64_t seed,
+          char** keys,
+          size_t* key_lens,
+          size_t n,
+          uint64_t* out)
+{
+  size_t done = 0;
+
+  if (hash == fnv_1a_hash_seeded) {
+    done = _fnv_1a_many(seed, keys, key_lens, n, out);
+  }
+
+  for (size_t i = done; i < n; i++) {
+    out[i] = hash(keys[i], key_lens[i], seed);
+  }
+}
+
+static const uint32_t CRC32C_TABLE[256] = {
+  0x00000000u, 0xf26b8303u, 0xe13b70f7u, 0x1350f3f4u, 0xc79a971fu,
+  0x35f1141cu, 0x26a1e7e8u, 0xd4ca64ebu, 0x8ad958cfu, 0x78b2dbccu,
+  0x6be22838u, 0x9989ab3bu, 0x4d43cfd0u, 0xbf284cd3u, 0xac78bf27u,
+  0x5e133c24u, 0x105ec76fu, 0xe235446cu, 0xf165b798u, 0x030e349bu,
+  0xd7c45070u, 0x25afd373u, 0x36ff2087u, 0xc494a384u, 0x9a879fa0u,
+  0x68ec1ca3u, 0x7bbcef57u, 0x89d76c54u, 0x5d1d08bfu, 0xaf768bbcu,
+  0xbc267848u, 0x4e4dfb4bu, 0x20bd8edeu, 0xd2d60dddu, 0xc186fe29u,
+  0x33ed7d2au, 0xe72719c1u, 0x154c9ac2u, 0x061c6936u, 0xf477ea35u,
+  0xaa64d611u, 0x580f5512u, 0x4b5fa6e6u, 0xb93425e5u, 0x6dfe410eu,
+  0x9f95c20du, 0x8cc531f9u, 0x7eaeb2fau, 0x30e349b1u, 0xc288cab2u,
+  0xd1d83946u, 0x23b3ba45u, 0xf779deaeu, 0x05125dadu, 0x1642ae59u,
+  0xe4292d5au, 0xba3a117eu, 0x4851927du, 0x5b016189u, 0xa96ae28au,
+  0x7da08661u, 0x8fcb0562u, 0x9c9bf696u, 0x6ef07595u, 0x417b1dbcu,
+  0xb3109ebfu, 0xa0406d4bu, 0x522bee48u, 0x86e18aa3u, 0x748a09a0u,
+  0x67dafa54u, 0x95b17957u, 0xcba24573u, 0x39c9c670u, 0x2a993584u,
+  0xd8f2b687u, 0x0c38d26cu, 0xfe53516fu, 0xed03a29bu, 0x1f682198u,
+  0x5125dad3u, 0xa34e59d0u, 0xb01eaa24u, 0x42752927u, 0x96bf4dccu,
+  0x64d4cecfu, 0x77843d3bu, 0x85efbe38u, 0xdbfc821cu, 0x2997011fu,
+  0x3ac7f2ebu, 0xc8ac71e8u, 0x1c661503u, 0xee0d9600u, 0xfd5d65f4u,
+  0x0f36e6f7u, 0x61c69362u, 0x93ad1061u, 0x80fde395u, 0x72966096u,
+  0xa65c047du, 0x5437877eu, 0x4767748au, 0xb50cf789u, 0xeb1fcbadu,
+  0x197448aeu, 0x0a24bb5au, 0xf84f3859u, 0x2c855cb2u, 0xdeeedfb1u,
+  0xcdbe2c45u, 0x3fd5af46u, 0x7198540du, 0x83f3d70eu, 0x90a324fau,
+  0x62c8a7f9u, 0xb602c312u, 0x44694011u, 0x5739b3e5u, 0xa55230e6u,
+  0xfb410cc2u, 0x092a8fc1u, 0x1a7a7c35u, 0xe811ff36u, 0x3cdb9bddu,
+  0xceb018deu, 0xdde0eb2au, 0x2f8b6829u, 0x82f63b78u, 0x709db87bu,
+  0x63cd4b8fu, 0x91a6c88cu, 0x456cac67u, 0xb7072f64u, 0xa457dc90u,
+  0x563c5f93u, 0x082f63b7u, 0xfa44e0b4u, 0xe9141340u, 0x1b7f9043u,
+  0xcfb5f4a8u, 0x3dde77abu, 0x2e8e845fu, 0xdce5075cu, 0x92a8fc17u,
+  0x60c37f14u, 0x73938ce0u, 0x81f80fe3u, 0x55326b08u, 0xa759e80bu,
+  0xb4091bffu, 0x466298fcu, 0x1871a4d8u, 0xea1a27dbu, 0xf94ad42fu,
+  0x0b21572cu, 0xdfeb33c7u, 0x2d80b0c4u, 0x3ed04330u, 0xccbbc033u,
+  0xa24bb5a6u, 0x502036a5u, 0x4370c551u, 0xb11b4652u, 0x65d122b9u,
+  0x97baa1bau, 0x84ea524eu, 0x7681d14du, 0x2892ed69u, 0xdaf96e6au,
+  0xc9a99d9eu, 0x3bc21e9du, 0xef087a76u, 0x1d63f975u, 0x0e330a81u,
+  0xfc588982u, 0xb21572c9u, 0x407ef1cau, 0x532e023eu, 0xa145813du,
+  0x758fe5d6u, 0x87e466d5u, 0x94b49521u, 0x66df1622u, 0x38cc2a06u,
+  0xcaa7a905u, 0xd9f75af1u, 0x2b9cd9f2u, 0xff56bd19u, 0x0d3d3e1au,
+  0x1e6dcdeeu, 0xec064eedu, 0xc38d26c4u, 0x31e6a5c7u, 0x22b65633u,
+  0xd0ddd530u, 0x0417b1dbu, 0xf67c32d8u, 0xe52cc12cu, 0x1747422fu,
+  0x49547e0bu, 0xbb3ffd08u, 0xa86f0efcu, 0x5a048dffu, 0x8ecee914u,
+  0x7ca56a17u, 0x6ff599e3u, 0x9d9e1ae0u, 0xd3d3e1abu, 0x21b862a8u,
+  0x32e8915cu, 0xc083125fu, 0x144976b4u, 0xe622f5b7u, 0xf5720643u,
+  0x07198540u, 0x590ab964u, 0xab613a67u, 0xb831c993u, 0x4a5a4a90u,
+  0x9e902e7bu, 0x6cfbad78u, 0x7fab5e8cu, 0x8dc0dd8fu, 0xe330a81au,
+  0x115b2b19u, 0x020bd8edu, 0xf0605beeu, 0x24aa3f05u, 0xd6c1bc06u,
+  0xc5914ff2u, 0x37faccf1u, 0x69e9f0d5u, 0x9b8273d6u, 0x88d28022u,
+  0x7ab90321u, 0xae7367cau, 0x5c18e4c9u, 0x4f48173du, 0xbd23943eu,
+  0xf36e6f75u, 0x0105ec76u, 0x12551f82u, 0xe03e9c81u, 0x34f4f86au,
+  0xc69f7b69u, 0xd5cf889du, 0x27a40b9eu, 0x79b737bau, 0x8bdcb4b9u,
+  0x988c474du, 0x6ae7c44eu, 0xbe2da0a5u, 0x4c4623a6u, 0x5f16d052u,
+  0xad7d5351u
+};
+
+static uint32_t
+_crc32c_table(uint32_t crc, const uint8_t* p, size_t len)
+{
+  for (size_t i = 0; i < len; i++) {
+    crc = CRC32C_TABLE[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+  }
+
+  return crc;
+}
+
+#ifdef CRC32C_SSE42
+/*
+ * The crc32 instruction consumes its operand's bytes in memory order on
+ * little endian x86, the same as that many steps of the table.
+ */
+__attribute__((target("sse4.2"))) static uint32_t
+_crc32c_sse42(uint32_t crc, const uint8_t* p, size_t len)
+{
+  uint64_t crc_64 = crc;
+  for (; len >= 8; len -= 8, p += 8) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    crc_64 = _mm_crc32_u64(crc_64, v);
+  }
+
+  // At most one step of each width finishes the tail
+  crc = (uint32_t)crc_64;
+  if (len & 4) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    crc = _mm_crc32_u32(crc, v);
+    p += 4;
+  }
+  if (len & 2) {
+    uint16_t v;
+    memcpy(&v, p, 2);
+    crc = _mm_crc32_u16(crc, v);
+    p += 2;
+  }
+  if (len & 1) {
+    crc = _mm_crc32_u8(crc, *p);
+  }
+
+  return crc;
+}
+#endif
+
+static inline uint32_t
+_crc32c_update(uint32_t crc, const uint8_t* p, size_t len)
+{
+#ifdef CRC32C_SSE42
+  if (__builtin_cpu_supports("sse4.2")) {
+    return _crc32c_sse42(crc, p, len);
+  }
+#endif
+  return _crc32c_table(crc, p, len);
+}
+
+uint32_t
+crc32c(char* data, size_t data_len, uint32_t crc)
+{
+  return ~_crc32c_update(~crc, (const uint8_t*)data, data_len);
+}
+
+/*
+ * Spreads a 32 bit CRC and the key length over 64 bits, so tables that
+ * index by the high bits see as much of the CRC as those using the low.
+ */
+static inline uint64_t
+_crc32c_finish(uint32_t crc, size_t data_len)
+{
+  return mix64(crc ^ ((uint64_t)data_len << 32));
+}
+
+static inline uint32_t
+_crc32c_seed(uint64_t seed)
+{
+  return (uint32_t)seed ^ (uint32_t)(seed >> 32);
+}
+
+uint64_t
+crc32c_hash(char* data, size_t data_len, uint64_t seed)
+{
+  return _crc32c_finish(crc32c(data, data_len, _crc32c_seed(seed)), data_len);
+}
+
+static const uint64_t WYHASH_SECRET[4] = { 0x2d358dccaa6c78a5u,
+                                           0x8bb84b93962eacc9u,
+                                           0x4b33a62ed433d4a3u,
+                                           0x4d5a2da51de1aa47u };
+
+static inline void
+_wymum(uint64_t* a, uint64_t* b)
+{
+#ifdef __SIZEOF_INT128__
+  __uint128_t r = *a;
+  r *= *b;
+  *a = (uint64_t)r;
+  *b = (uint64_t)(r >> 64);
+#else
+  uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+  *a = lo;
+  *b = hi;
+#endif
+}
+
+static inline uint64_t
+_wymix(uint64_t a, uint64_t b)
+{
+  _wymum(&a, &b);
+  return a ^ b;
+}
+
+static inline uint64_t
+_wyr8(const uint8_t* p)
+{
+  uint64_t v;
+  memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
+}
+
+static inline uint64_t
+_wyr4(const uint8_t* p)
+{
+  uint32_t v;
+  memcpy(&v, p, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap32(v);
+#endif
+  return v;
+}
+
+static inline uint64_t
+_wyr3(const uint8_t* p, size_t k)
+{
+  return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+static inline uint64_t
+_wyhash_seed(uint64_t seed)
+{
+  return seed ^ _wymix(seed ^ WYHASH_SECRET[0], WYHASH_SECRET[1]);
+}
+
+/*
+ * Mixes one 48 byte block into the three lanes of the long key loop.
+ */
+static inline void
+_wyhash_block(const uint8_t* p, uint64_t* seed, uint64_t* see1, uint64_t* see2)
+{
+  const uint64_t* secret = WYHASH_SECRET;
+
+  *seed = _wymix(_wyr8(p) ^ secret[1], _wyr8(p + 8) ^ *seed);
+  *see1 = _wymix(_wyr8(p + 16) ^ secret[2], _wyr8(p + 24) ^ *see1);
+  *see2 = _wymix(_wyr8(p + 32) ^ secret[3], _wyr8(p + 40) ^ *see2);
+}
+
+/*
+ * Finishes a hash from the i bytes at p left after the 48 byte blocks. Keys
+ * over 16 bytes read their last 16 bytes, so when i < 16 the bytes before p
+ * must be the end of the last block.
+ */
+static inline uint64_t
+_wyhash_tail(const uint8_t* p, size_t i, uint64_t seed, size_t data_len)
+{
+  const uint64_t* secret = WYHASH_SECRET;
+
+  uint64_t a, b;
+  if (data_len <= 16) {
+    if (data_len >= 4) {
+      a = (_wyr4(p) << 32) | _wyr4(p + ((data_len >> 3) << 2));
+      b = (_wyr4(p + data_len - 4) << 32) |
+          _wyr4(p + data_len - 4 - ((data_len >> 3) << 2));
+    } else if (data_len > 0) {
+      a = _wyr3(p, data_len);
+      b = 0;
+    } else {
+      a = 0;
+      b = 0;
+    }
+  } else {
+    while (i > 16) {
+      seed = _wymix(_wyr8(p) ^ secret[1], _wyr8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = _wyr8(p + i - 16);
+    b = _wyr8(p + i - 8);
+  }
+
+  a ^= secret[1];
+  b ^= seed;
+  _wymum(&a, &b);
+
+  return _wymix(a ^ secret[0] ^ data_len, b ^ secret[1]);
+}
+
+uint64_t
+wyhash(char* data, size_t data_len, uint64_t seed)
+{
+  const uint8_t* p = (const uint8_t*)data;
+  size_t i = data_len;
+
+  seed = _wyhash_seed(seed);
+
+  if (i >= 48) {
+    uint64_t see1 = seed, see2 = seed;
+    do {
+      _wyhash_block(p, &seed, &see1, &see2);
+      p += 48;
+      i -= 48;
+    } while (i >= 48);
+    seed ^= see1 ^ see2;
+  }
+
+  return _wyhash_tail(p, i, seed, data_len);
+}
+
+void
+Hash_init(struct HashState* state, HashFunction hash, uint64_t seed)
+{
+  assert(hash == fnv_1a_hash_seeded || hash == wyhash || hash == crc32c_hash);
+
+  state->hash = hash;
+  state->len = 0;
+  state->buffer_len = 0;
+
+  if (hash == fnv_1a_hash_seeded) {
+    state->seed = FNV_OFFSET ^ seed;
+  } else if (hash == crc32c_hash) {
+    state->seed = (uint32_t)~_crc32c_seed(seed);
+  } else {
+    state->seed = _wyhash_seed(seed);
+    state->see1 = state->seed;
+    state->see2 = state->seed;
+  }
+}
+
+static void
+_Hash_update_wyhash(struct HashState* state, const uint8_t* p, size_t len)
+{
+  uint8_t* block = state->buffer + 16;
+
+  // Top up a partial block first, then mix whole blocks straight from the
+  // input. A block is mixed as soon as it is complete, matching the one-shot
+  // loop, which runs while at least 48 bytes remain.
+  if (state->buffer_len > 0) {
+    size_t n = 48 - state->buffer_len;
+    if (n > len) {
+      n = len;
+    }
+    memcpy(block + state->buffer_len, p, n);
+    state->buffer_len += n;
+    p += n;
+    len -= n;
+
+    if (state->buffer_len < 48) {
+      return;
+    }
+    _wyhash_block(block, &state->seed, &state->see1, &state->see2);
+    memcpy(state->buffer, block + 32, 16);
+    state->buffer_len = 0;
+  }
+
+  if (len >= 48) {
+    do {
+      _wyhash_block(p, &state->seed, &state->see1, &state->see2);
+      p += 48;
+      len -= 48;
+    } while (len >= 48);
+    memcpy(state->buffer, p - 16, 16);
+  }
+
+  memcpy(block, p, len);
+  state->buffer_len = len;
+}
+
+void
+Hash_update(struct HashState* state, char* data, size_t data_len)
+{
+  if (state->hash == fnv_1a_hash_seeded) {
+    uint64_t hash = state->seed;
+    for (size_t i = 0; i < data_len; i++) {
+      hash ^= data[i];
+      hash *= FNV_PRIME;
+    }
+    state->seed = hash;
+  } else if (state->hash == crc32c_hash) {
+    state->seed =
+      _crc32c_update((uint32_t)state->seed, (const uint8_t*)data, data_len);
+  } else if (data_len > 0) {
+    _Hash_update_wyhash(state, (const uint8_t*)data, data_len);
+  }
+
+  state->len += data_len;
+}
+
+uint64_t
+Hash_final(const struct HashState* state)
+{
+  if (state->hash == fnv_1a_hash_seeded) {
+    return state->seed;
+  } else if (state->hash == crc32c_hash) {
+    return _crc32c_finish(~(uint32_t)state->seed, state->len);
+  }
+
+  uint64_t seed = state->seed;
+  if (state->len >= 48) {
+    seed ^= state->see1 ^ state->see2;
+  }
+
+  return _wyhash_tail(
+    state->buffer + 16, state->buffer_len, seed, state->len);
+}
@@ -0,0 +1,398 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hyperloglog.h"
+#include "constants.h"
+#include "hash.h"
+#include "set.h"
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HYPERLOGLOG_SPARSE 0
+#define HYPERLOGLOG_DENSE 1
+
+// Precision, encoding and seed, then the sparse length or the registers
+#define HYPERLOGLOG_HEADER_SIZE 10
+
+/*
+ * Sparse entries hold the register index above 6 bits of register value,
+ * so they sort by index.
+ */
+#define SPARSE_ENTRY(idx, value) (((uint32_t)(idx) << 6) | (value))
+#define SPARSE_IDX(entry) ((entry) >> 6)
+#define SPARSE_VALUE(entry) ((uint8_t)((entry) & 0x3f))
+
+struct HyperLogLog*
+HyperLogLog_new(unsigned int precision)
+{
+  return HyperLogLog_new_with_hash(precision, wyhash, 0);
+}
+
+struct HyperLogLog*
+HyperLogLog_new_with_hash(unsigned int precision,
+                          HashFunction hash,
+                          uint64_t seed)
+{
+  assert(precision >= HYPERLOGLOG_MIN_PRECISION &&
+         precision <= HYPERLOGLOG_MAX_PRECISION);
+
+  struct HyperLogLog* h = malloc(sizeof(struct HyperLogLog));
+
+  h->registers = NULL;
+  h->sparse = NULL;
+  h->sparse_len = 0;
+  h->sparse_capacity = 0;
+  h->precision = precision;
+  h->hash = hash;
+  h->seed = seed;
+
+  return h;
+}
+
+void
+HyperLogLog_free(struct HyperLogLog* h)
+{
+  free(h->registers);
+  free(h->sparse);
+  free(h);
+}
+
+static inline unsigned int
+_leading_zeros(uint64_t x)
+{
+#if defined(__GNUC__)
+  return (unsigned int)__builtin_clzll(x);
+#else
+  unsigned int i = 0;
+  while ((x & ((uint64_t)1 << 63)) == 0) {
+    x <<= 1;
+    i += 1;
+  }
+  return i;
+#endif
+}
+
+static void
+_HyperLogLog_to_dense(struct HyperLogLog* h)
+{
+  h->registers = calloc((size_t)1 << h->precision, sizeof(uint8_t));
+
+  for (size_t i = 0; i < h->sparse_len; i++) {
+    h->registers[SPARSE_IDX(h->sparse[i])] = SPARSE_VALUE(h->sparse[i]);
+  }
+
+  free(h->sparse);
+  h->sparse = NULL;
+  h->sparse_len = 0;
+  h->sparse_capacity = 0;
+}
+
+static void
+_HyperLogLog_set(struct HyperLogLog* h, size_t idx, uint8_t value)
+{
+  if (h->registers != NULL) {
+    if (h->registers[idx] < value) {
+      h->registers[idx] = value;
+    }
+    return;
+  }
+
+  // Binary search for the first entry at or after idx
+  size_t lo = 0;
+  size_t hi = h->sparse_len;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (SPARSE_IDX(h->sparse[mid]) < idx) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  if (lo < h->sparse_len && SPARSE_IDX(h->sparse[lo]) == idx) {
+    if (SPARSE_VALUE(h->sparse[lo]) < value) {
+      h->sparse[lo] = SPARSE_ENTRY(idx, value);
+    }
+    return;
+  }
+
+  // Go dense once the entries would take as much space as the registers
+  size_t m = (size_t)1 << h->precision;
+  if ((h->sparse_len + 1) * sizeof(uint32_t) >= m) {
+    _HyperLogLog_to_dense(h);
+    h->registers[idx] = value;
+    return;
+  }
+
+  if (h->sparse_len == h->sparse_capacity) {
+    h->sparse_capacity = h->sparse_capacity == 0 ? 16 : h->sparse_capacity * 2;
+    h->sparse = realloc(h->sparse, h->sparse_capacity * sizeof(uint32_t));
+  }
+
+  memmove(&h->sparse[lo + 1],
+          &h->sparse[lo],
+          (h->sparse_len - lo) * sizeof(uint32_t));
+  h->sparse[lo] = SPARSE_ENTRY(idx, value);
+  h->sparse_len += 1;
+}
+
+void
+HyperLogLog_add_hash(struct HyperLogLog* h, uint64_t hash)
+{
+  unsigned int q = 64 - h->precision;
+  size_t idx = (size_t)(hash >> q);
+
+  // Position of the first set bit in the low q bits, q + 1 if none is set
+  uint64_t rest = hash << h->precision;
+  uint8_t value = (uint8_t)(rest == 0 ? q + 1 : _leading_zeros(rest) + 1);
+
+  _HyperLogLog_set(h, idx, value);
+}
+
+void
+HyperLogLog_add(struct HyperLogLog* h, char* key, size_t key_len)
+{
+  HyperLogLog_add_hash(h, h->hash(key, key_len, h->seed));
+}
+
+void
+HyperLogLog_add_keys(struct HyperLogLog* h,
+                     char** keys,
+                     size_t* key_lens,
+                     size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    HyperLogLog_add(h, keys[i], key_lens[i]);
+  }
+}
+
+void
+HyperLogLog_add_iterator(struct HyperLogLog* h, struct SetIterator* iterator)
+{
+  int cached =
+    iterator->set->hash == h->hash && iterator->set->seed == h->seed;
+
+  for (struct SetItem* item = SetIterator_next(iterator); item != NULL;
+       item = SetIterator_next(iterator)) {
+    HyperLogLog_add_hash(
+      h, cached ? item->hash : h->hash(item->key, item->key_len, h->seed));
+  }
+}
+
+static double
+_hyperloglog_sigma(double x)
+{
+  if (x == 1) {
+    return INFINITY;
+  }
+
+  double y = 1;
+  double z = x;
+  double z_prev;
+  do {
+    x *= x;
+    z_prev = z;
+    z += x * y;
+    y += y;
+  } while (z != z_prev);
+
+  return z;
+}
+
+static double
+_hyperloglog_tau(double x)
+{
+  if (x == 0 || x == 1) {
+    return 0;
+  }
+
+  double y = 1;
+  double z = 1 - x;
+  double z_prev;
+  do {
+    x = sqrt(x);
+    z_prev = z;
+    y *= 0.5;
+    z -= (1 - x) * (1 - x) * y;
+  } while (z != z_prev);
+
+  return z / 3;
+}
+
+size_t
+HyperLogLog_estimate(struct HyperLogLog* h)
+{
+  unsigned int q = 64 - h->precision;
+  double m = (double)((size_t)1 << h->precision);
+
+  // Histogram of register values, unset registers are all 0
+  double counts[66] = { 0 };
+  if (h->registers != NULL) {
+    for (size_t i = 0; i < ((size_t)1 << h->precision); i++) {
+      counts[h->registers[i]] += 1;
+    }
+  } else {
+    for (size_t i = 0; i < h->sparse_len; i++) {
+      counts[SPARSE_VALUE(h->sparse[i])] += 1;
+    }
+    counts[0] = m - (double)h->sparse_len;
+  }
+
+  // Ertl's improved estimator, which needs no bias correction across the
+  // whole range from empty to saturated
+  double z = m * _hyperloglog_tau(1 - counts[q + 1] / m);
+  for (unsigned int k = q; k >= 1; k--) {
+    z = 0.5 * (z + counts[k]);
+  }
+  z += m * _hyperloglog_sigma(counts[0] / m);
+
+  return (size_t)llround(m * m / (2 * LN_2 * z));
+}
+
+void
+HyperLogLog_merge(struct HyperLogLog* dst, struct HyperLogLog* src)
+{
+  assert(dst->precision == src->precision);
+  assert(dst->hash == src->hash && dst->seed == src->seed);
+
+  if (src->registers == NULL) {
+    for (size_t i = 0; i < src->sparse_len; i++) {
+      _HyperLogLog_set(
+        dst, SPARSE_IDX(src->sparse[i]), SPARSE_VALUE(src->sparse[i]));
+    }
+    return;
+  }
+
+  if (dst->registers == NULL) {
+    _HyperLogLog_to_dense(dst);
+  }
+
+  for (size_t i = 0; i < ((size_t)1 << dst->precision); i++) {
+    if (dst->registers[i] < src->registers[i]) {
+      dst->registers[i] = src->registers[i];
+    }
+  }
+}
+
+size_t
+HyperLogLog_serialized_size(struct HyperLogLog* h)
+{
+  if (h->registers != NULL) {
+    return HYPERLOGLOG_HEADER_SIZE + ((size_t)1 << h->precision);
+  }
+
+  return HYPERLOGLOG_HEADER_SIZE + 4 + h->sparse_len * 4;
+}
+
+static void
+_write_u32(uint8_t* data, uint32_t x)
+{
+  for (size_t i = 0; i < 4; i++) {
+    data[i] = (uint8_t)(x >> (i * 8));
+  }
+}
+
+static uint32_t
+_read_u32(const uint8_t* data)
+{
+  uint32_t x = 0;
+  for (size_t i = 0; i < 4; i++) {
+    x |= (uint32_t)data[i] << (i * 8);
+  }
+  return x;
+}
+
+void
+HyperLogLog_serialize(struct HyperLogLog* h, uint8_t* data)
+{
+  // Little endian throughout, so the bytes do not depend on the platform
+  data[0] = (uint8_t)h->precision;
+  data[1] = h->registers != NULL ? HYPERLOGLOG_DENSE : HYPERLOGLOG_SPARSE;
+  for (size_t i = 0; i < 8; i++) {
+    data[2 + i] = (uint8_t)(h->seed >> (i * 8));
+  }
+  data += HYPERLOGLOG_HEADER_SIZE;
+
+  if (h->registers != NULL) {
+    memcpy(data, h->registers, (size_t)1 << h->precision);
+    return;
+  }
+
+  _write_u32(data, (uint32_t)h->sparse_len);
+  for (size_t i = 0; i < h->sparse_len; i++) {
+    _write_u32(data + 4 + i * 4, h->sparse[i]);
+  }
+}
+
+struct HyperLogLog*
+HyperLogLog_deserialize(const uint8_t* data,
+                        size_t data_len,
+                        HashFunction hash)
+{
+  if (data_len < HYPERLOGLOG_HEADER_SIZE ||
+      data[0] < HYPERLOGLOG_MIN_PRECISION ||
+      data[0] > HYPERLOGLOG_MAX_PRECISION) {
+    return NULL;
+  }
+
+  unsigned int precision = data[0];
+  size_t m = (size_t)1 << precision;
+  uint8_t max_value = (uint8_t)(64 - precision + 1);
+
+  uint64_t seed = 0;
+  for (size_t i = 0; i < 8; i++) {
+    seed |= (uint64_t)data[2 + i] << (i * 8);
+  }
+
+  const uint8_t* body = data + HYPERLOGLOG_HEADER_SIZE;
+  size_t body_len = data_len - HYPERLOGLOG_HEADER_SIZE;
+
+  struct HyperLogLog* h = HyperLogLog_new_with_hash(precision, hash, seed);
+
+  if (data[1] == HYPERLOGLOG_DENSE && body_len == m) {
+    h->registers = malloc(m);
+    memcpy(h->registers, body, m);
+    for (size_t i = 0; i < m; i++) {
+      if (h->registers[i] > max_value) {
+        HyperLogLog_free(h);
+        return NULL;
+      }
+    }
+    return h;
+  }
+
+  if (data[1] != HYPERLOGLOG_SPARSE || body_len < 4 ||
+      body_len != 4 + (size_t)_read_u32(body) * 4) {
+    HyperLogLog_free(h);
+    return NULL;
+  }
+
+  size_t sparse_len = _read_u32(body);
+  for (size_t i = 0; i < sparse_len; i++) {
+    uint32_t entry = _read_u32(body + 4 + i * 4);
+    if (SPARSE_IDX(entry) >= m || SPARSE_VALUE(entry) > max_value) {
+      HyperLogLog_free(h);
+      return NULL;
+    }
+    _HyperLogLog_set(h, SPARSE_IDX(entry), SPARSE_VALUE(entry));
+  }
+
+  return h;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "map.h"
+#include "hash.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdlib.h>
+
+struct Map*
+Map_new(size_t inital_capacity)
+{
+  return Map_new_with_options(inital_capacity, 0, wyhash, 0);
+}
+
+struct Map*
+Map_new_with_options(size_t inital_capacity,
+                     unsigned int flags,
+                     HashFunction hash,
+                     uint64_t seed)
+{
+  struct Map* m = malloc(sizeof(struct Map));
+
+  m->set =
+    Set_new_with_options(inital_capacity, flags | SET_VALUES, hash, seed);
+
+  return m;
+}
+
+void
+Map_free(struct Map* m)
+{
+  Set_free(m->set);
+  free(m);
+}
+
+void*
+Map_get(struct Map* m, char* key, size_t key_len)
+{
+  struct SetItem* item = Set_get(m->set, key, key_len);
+
+  return item != NULL ? *Set_value(m->set, item) : NULL;
+}
+
+struct SetItem*
+Map_put(struct Map* m, char* key, size_t key_len, void* value)
+{
+  struct SetItem* item = Set_put(m->set, key, key_len);
+  *Set_value(m->set, item) = value;
+
+  return item;
+}
+
+void*
+Map_get_or_insert(struct Map* m, char* key, size_t key_len, void* value)
+{
+  int inserted;
+
+  struct SetItem* item = Set_insert_or_find(m->set, key, key_len, &inserted);
+  void** slot = Set_value(m->set, item);
+  if (inserted) {
+    *slot = value;
+  }
+
+  return *slot;
+}
+
+void*
+Map_delete(struct Map* m, char* key, size_t key_len)
+{
+  return Set_delete_value(m->set, key, key_len);
+}
+
+struct MapIterator*
+MapIterator_new(struct Map* m)
+{
+  struct MapIterator* iterator = malloc(sizeof(struct MapIterator));
+
+  iterator->iterator = SetIterator_new(m->set);
+  iterator->value = NULL;
+
+  return iterator;
+}
+
+void
+MapIterator_free(struct MapIterator* iterator)
+{
+  SetIterator_free(iterator->iterator);
+  free(iterator);
+}
+
+struct SetItem*
+MapIterator_next(struct MapIterator* iterator)
+{
+  struct SetItem* item = SetIterator_next(iterator->iterator);
+
+  iterator->value =
+    item != NULL ? *Set_value(iterator->iterator->set, item) : NULL;
+
+  return item;
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rcu_set.h"
+#include "set.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct RcuSet*
+RcuSet_new(size_t inital_capacity,
+           size_t reader_count,
+           unsigned int flags,
+           HashFunction hash,
+           uint64_t seed)
+{
+  assert(reader_count > 0);
+
+  // Dropped rather than asserted on, readers must never modify the set
+  flags &= ~SET_INCREMENTAL_RESIZE;
+
+  struct RcuSet* s = malloc(sizeof(struct RcuSet));
+
+  atomic_init(&s->current,
+              Set_new_with_options(inital_capacity, flags, hash, seed));
+  atomic_init(&s->epoch, 1);
+
+  s->readers = aligned_alloc(_Alignof(struct RcuSetReader),
+                             reader_count * sizeof(struct RcuSetReader));
+  for (size_t i = 0; i < reader_count; i++) {
+    atomic_init(&s->readers[i].epoch, 0);
+  }
+  s->reader_count = reader_count;
+
+  pthread_mutex_init(&s->writer, NULL);
+  s->retired = NULL;
+
+  return s;
+}
+
+void
+RcuSet_free(struct RcuSet* s)
+{
+  struct RcuSetRetired* retired = s->retired;
+  while (retired != NULL) {
+    struct RcuSetRetired* next = retired->next;
+    Set_free(retired->set);
+    free(retired);
+    retired = next;
+  }
+
+  Set_free(atomic_load_explicit(&s->current, memory_order_relaxed));
+  pthread_mutex_destroy(&s->writer);
+  free(s->readers);
+  free(s);
+}
+
+int
+RcuSet_has(struct RcuSet* s, size_t reader, char* key, size_t key_len)
+{
+  assert(reader < s->reader_count);
+
+  struct RcuSetReader* slot = &s->readers[reader];
+
+  // Announce the epoch before loading the set. The fence pairs with the one
+  // in _RcuSet_reclaim, so either the writer sees this slot or this reader
+  // sees the set the writer published.
+  uint64_t epoch = atomic_load_explicit(&s->epoch, memory_order_acquire);
+  atomic_store_explicit(&slot->epoch, epoch, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+
+  struct Set* set = atomic_load_explicit(&s->current, memory_order_acquire);
+  int res = Set_has(set, key, key_len);
+
+  atomic_store_explicit(&slot->epoch, 0, memory_order_release);
+
+  return res;
+}
+
+/*
+ * Frees every retired set that no active reader entered early enough to
+ * see. Called with the writer mutex held.
+ */
+static void
+_RcuSet_reclaim(struct RcuSet* s)
+{
+  atomic_thread_fence(memory_order_seq_cst);
+
+  uint64_t oldest = UINT64_MAX;
+  for (size_t i = 0; i < s->reader_count; i++) {
+    uint64_t epoch =
+      atomic_load_explicit(&s->readers[i].epoch, memory_order_acquire);
+    if (epoch != 0 && epoch < oldest) {
+      oldest = epoch;
+    }
+  }
+
+  struct RcuSetRetired** link = &s->retired;
+  while (*link != NULL) {
+    struct RcuSetRetired* retired = *link;
+    if (retired->epoch < oldest) {
+      *link = retired->next;
+      Set_free(retired->set);
+      free(retired);
+    } else {
+      link = &retired->next;
+    }
+  }
+}
+
+/*
+ * Swaps in next and retires the old set at the current epoch, then moves
+ * to the next epoch. Readers that enter from then on can only see next.
+ * Called with the writer mutex held.
+ */
+static void
+_RcuSet_publish(struct RcuSet* s, struct Set* next)
+{
+  struct Set* old = atomic_load_explicit(&s->current, memory_order_relaxed);
+  uint64_t epoch = atomic_load_explicit(&s->epoch, memory_order_relaxed);
+
+  atomic_store_explicit(&s->current, next, memory_order_release);
+  atomic_store_explicit(&s->epoch, epoch + 1, memory_order_release);
+
+  struct RcuSetRetired* retired = malloc(sizeof(struct RcuSetRetired));
+  retired->set = old;
+  retired->epoch = epoch;
+  retired->next = s->retired;
+  s->retired = retired;
+
+  _RcuSet_reclaim(s);
+}
+
+void
+RcuSet_put(struct RcuSet* s, char* key, size_t key_len)
+{
+  pthread_mutex_lock(&s->writer);
+
+  struct Set* current = atomic_load_explicit(&s->current, memory_order_relaxed);
+  if (!Set_has(current, key, key_len)) {
+    struct Set* next = Set_copy(current);
+    Set_put(next, key, key_len);
+    _RcuSet_publish(s, next);
+  }
+
+  pthread_mutex_unlock(&s->writer);
+}
+
+void
+RcuSet_delete(struct RcuSet* s, char* key, size_t key_len)
+{
+  pthread_mutex_lock(&s->writer);
+
+  struct Set* current = atomic_load_explicit(&s->current, memory_order_relaxed);
+  if (Set_has(current, key, key_len)) {
+    struct Set* next = Set_copy(current);
+    Set_delete(next, key, key_len);
+    _RcuSet_publish(s, next);
+  }
+
+  pthread_mutex_unlock(&s->writer);
+}
+
+void
+RcuSet_replace(struct RcuSet* s, struct Set* next)
+{
+  // Readers must never modify the set, so finish any pending resize and
+  // keep later copies of it from starting one
+  Set_finish_resize(next);
+  next->flags &= ~SET_INCREMENTAL_RESIZE;
+
+  pthread_mutex_lock(&s->writer);
+  _RcuSet_publish(s, next);
+  pthread_mutex_unlock(&s->writer);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "segmented_set.h"
+#include "hash.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+void
+SegmentedSet_init(struct SegmentedSet* s,
+                  size_t inital_capacity,
+                  size_t segment_count,
+                  unsigned int flags,
+                  HashFunction hash,
+                  uint64_t seed)
+{
+  s->segment_bits = 0;
+  while (((size_t)1 << s->segment_bits) < segment_count) {
+    s->segment_bits += 1;
+  }
+  s->segment_count = (size_t)1 << s->segment_bits;
+  s->hash = hash;
+  s->seed = seed;
+
+  size_t segment_capacity = inital_capacity / s->segment_count;
+  if (segment_capacity < 2) {
+    segment_capacity = 2;
+  }
+
+  s->segments = aligned_alloc(_Alignof(struct SegmentedSetSegment),
+                              s->segment_count *
+                                sizeof(struct SegmentedSetSegment));
+  for (size_t i = 0; i < s->segment_count; i++) {
+    s->segments[i].set =
+      Set_new_with_options(segment_capacity, flags, hash, seed);
+  }
+}
+
+void
+SegmentedSet_destroy(struct SegmentedSet* s)
+{
+  for (size_t i = 0; i < s->segment_count; i++) {
+    Set_free(s->segments[i].set);
+  }
+
+  free(s->segments);
+}
@@ -15,21 +15,207 @@
  */
 
 #include "set.h"
+#include "arena.h"
+#include "constants.h"
 #include "hash.h"
 #include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define SET_ARENA_CHUNK_SIZE (64 * 1024)
+
+#define SET_RESIZE_STEPS 32
+
+#define SET_BATCH_SIZE 16
+
+// Parallel builds split the result table into at most this many parts, of
+// at least SET_PARALLEL_MIN_SLOTS slots each
+#define SET_PARALLEL_MAX_PARTS 64
+#define SET_PARALLEL_MIN_SLOTS 64
+
+#define SET_MAX_LOAD 0.75f
+#define SET_ROBIN_HOOD_MAX_LOAD 0.9f
+
+#define SWISS_GROUP_WIDTH 16
+#define SWISS_EMPTY 0x80
+#define SWISS_DELETED 0xfe
+
+#ifdef __GNUC__
+#define SET_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define SET_PREFETCH(addr) ((void)(addr))
+#endif
+
+static inline int
+_SetItem_is_inline(const struct SetItem* item)
+{
+  return item->key_len <= SET_INLINE_KEY_LEN;
+}
+
+static inline int
+_SetItem_matches(const struct SetItem* item,
+                 uint64_t hash,
+                 const char* key,
+                 size_t key_len)
+{
+  if (item->hash != hash || item->key_len != key_len) {
+    return 0;
+  }
+
+  // Inline keys are compared in place without loading the key pointer
+  const char* item_key =
+    _SetItem_is_inline(item) ? item->inline_key : item->key;
+  return memcmp(item_key, key, key_len) == 0;
+}
+
+/*
+ * Copies an entry between slots, re-pointing inline keys at the destination.
+ */
+static inline void
+_SetItem_move(struct SetItem* dst, const struct SetItem* src)
+{
+  *dst = *src;
+  if (_SetItem_is_inline(dst)) {
+    dst->key = dst->inline_key;
+  }
+}
+
+static inline void
+_SetItem_free_key(struct Set* s, struct SetItem* item)
+{
+  // Arena keys are only released with the whole arena
+  if (!_SetItem_is_inline(item) && s->arena == NULL) {
+    free(item->key);
+  }
+}
+
+static inline struct SetItem*
+_Set_item(const struct Set* s, size_t idx)
+{
+  return (struct SetItem*)((char*)s->table + idx * s->item_size);
+}
+
+static inline size_t
+_Set_index(const struct Set* s, const struct SetItem* item)
+{
+  if (s->flags & SET_VALUES) {
+    return (size_t)((const struct SetValueItem*)item -
+                    (const struct SetValueItem*)s->table);
+  }
+
+  return (size_t)(item - s->table);
+}
+
+/*
+ * Value of an item in the table of s, NULL for sets without SET_VALUES.
+ */
+static inline void*
+_Set_value(const struct Set* s, const struct SetItem* item)
+{
+  if (s->flags & SET_VALUES) {
+    return ((const struct SetValueItem*)item)->value;
+  }
+
+  return NULL;
+}
+
+static inline void
+_Set_set_value(struct Set* s, struct SetItem* item, void* value)
+{
+  if (s->flags & SET_VALUES) {
+    ((struct SetValueItem*)item)->value = value;
+  }
+}
+
+/*
+ * Points the set at a new empty table of the given capacity.
+ */
+static void
+_Set_alloc_table(struct Set* s, size_t capacity)
+{
+  s->table = calloc(capacity, s->item_size);
+
+  s->ctrl = NULL;
+  if (s->flags & SET_SWISS_TABLE) {
+    s->ctrl = malloc(capacity + SWISS_GROUP_WIDTH);
+    memset(s->ctrl, SWISS_EMPTY, capacity + SWISS_GROUP_WIDTH);
+  }
+
+  s->shift = 64;
+  if (s->flags & SET_POW2_CAPACITY) {
+    for (size_t c = capacity; c > 1; c >>= 1) {
+      s->shift -= 1;
+    }
+  }
+
+  s->capacity = capacity;
+  s->deleted = 0;
+}
 
 struct Set*
 Set_new(size_t inital_capacity)
 {
+  return Set_new_with_hash(inital_capacity, wyhash, 0);
+}
+
+struct Set*
+Set_new_with_hash(size_t inital_capacity, HashFunction hash, uint64_t seed)
+{
+  return Set_new_with_options(inital_capacity, 0, hash, seed);
+}
+
+struct Set*
+Set_new_with_options(size_t inital_capacity,
+                     unsigned int flags,
+                     HashFunction hash,
+                     uint64_t seed)
+{
+  assert(hash != NULL);
+
   struct Set* s = malloc(sizeof(struct Set));
 
-  s->table = calloc(inital_capacity, sizeof(struct SetItem));
+  assert(!((flags & SET_SWISS_TABLE) && (flags & SET_ROBIN_HOOD)));
+
+  if (flags & SET_SWISS_TABLE) {
+    flags |= SET_POW2_CAPACITY;
+    if (inital_capacity < SWISS_GROUP_WIDTH) {
+      inital_capacity = SWISS_GROUP_WIDTH;
+    }
+  }
+
+  if (flags & SET_POW2_CAPACITY) {
+    size_t capacity = 2;
+    while (capacity < inital_capacity) {
+      capacity *= 2;
+    }
+    inital_capacity = capacity;
+  }
 
-  s->capacity = inital_capacity;
   s->load = 0;
+  s->hash = hash;
+  s->seed = seed;
+  s->flags = flags;
+  s->item_size = flags & SET_VALUES ? sizeof(struct SetValueItem)
+                                    : sizeof(struct SetItem);
+
+  _Set_alloc_table(s, inital_capacity);
+
+  s->arena = NULL;
+  if (flags & SET_ARENA_KEYS) {
+    s->arena = Arena_new(SET_ARENA_CHUNK_SIZE);
+  }
+
+  s->resize_from = NULL;
+  s->resize_idx = 0;
 
   return s;
 }
@@ -37,186 +223,1462 @@ Set_new(size_t inital_capacity)
 void
 Set_free(struct Set* s)
 {
-  for (size_t i = 0; i < s->capacity; i++) {
-    if (s->table[i].key != NULL) {
-      free(s->table[i].key);
+  struct Set* old = s->resize_from;
+
+  if (s->arena != NULL) {
+    Arena_free(s->arena);
+  } else {
+    for (size_t i = 0; i < s->capacity; i++) {
+      struct SetItem* item = _Set_item(s, i);
+      if (item->key != NULL) {
+        _SetItem_free_key(s, item);
+      }
+    }
+    for (size_t i = 0; old != NULL && i < old->capacity; i++) {
+      struct SetItem* item = _Set_item(old, i);
+      if (item->key != NULL) {
+        _SetItem_free_key(s, item);
+      }
     }
   }
 
+  if (old != NULL) {
+    free(old->ctrl);
+    free(old->table);
+    free(old);
+  }
+
+  free(s->ctrl);
+  free(s->table);
   free(s);
 }
 
-static int
-_key_cmp(const char* key_a,
-         size_t key_a_len,
-         const char* key_b,
-         size_t key_b_len)
+static inline size_t
+_Set_home(const struct Set* s, uint64_t hash)
 {
-  size_t min_len = key_a_len < key_b_len ? key_a_len : key_b_len;
-
-  int cmp = memcmp(key_a, key_b, min_len);
-  if (cmp != 0 || key_a_len == key_b_len) {
-    return cmp;
+  if (s->flags & SET_POW2_CAPACITY) {
+    return (size_t)((hash * FIBONACCI_MULTIPLIER) >> s->shift);
   }
 
-  return key_a_len < key_b_len ? -1 : 1;
+  return hash % s->capacity;
 }
 
-int
-Set_has(struct Set* s, char* key, size_t key_len)
+static inline size_t
+_Set_next(const struct Set* s, size_t idx)
 {
-  assert(key_len > 0);
+  return idx + 1 == s->capacity ? 0 : idx + 1;
+}
 
-  size_t idx = fnv_1a_hash(key, key_len) % s->capacity;
+/*
+ * Bit mask of the slots in the 16 byte control group starting at ctrl whose
+ * tag equals the given byte.
+ */
+static inline unsigned int
+_swiss_match(const uint8_t* ctrl, uint8_t tag)
+{
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+  return (unsigned int)_mm_movemask_epi8(
+    _mm_cmpeq_epi8(group, _mm_set1_epi8((char)tag)));
+#else
+  unsigned int mask = 0;
+  for (int i = 0; i < SWISS_GROUP_WIDTH; i++) {
+    mask |= (unsigned int)(ctrl[i] == tag) << i;
+  }
+  return mask;
+#endif
+}
 
-  for (size_t i = 0; i < s->capacity; i++) {
-    struct SetItem* item = &s->table[(idx + i) % s->capacity];
-    if (item->key == NULL) {
-      return 0;
-    } else if (_key_cmp(item->key, item->key_len, key, key_len) == 0) {
-      return 1;
-    }
+/*
+ * Bit mask of the empty or deleted slots in the control group. Both markers
+ * have the high bit set, full slots never do.
+ */
+static inline unsigned int
+_swiss_match_free(const uint8_t* ctrl)
+{
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+  return (unsigned int)_mm_movemask_epi8(group);
+#else
+  unsigned int mask = 0;
+  for (int i = 0; i < SWISS_GROUP_WIDTH; i++) {
+    mask |= (unsigned int)(ctrl[i] >> 7) << i;
   }
+  return mask;
+#endif
+}
 
-  return 0;
+static inline unsigned int
+_swiss_lowest_bit(unsigned int mask)
+{
+#if defined(__GNUC__)
+  return (unsigned int)__builtin_ctz(mask);
+#else
+  unsigned int i = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    i += 1;
+  }
+  return i;
+#endif
+}
+
+static inline uint8_t
+_swiss_tag(uint64_t hash)
+{
+  return (uint8_t)(hash & 0x7f);
 }
 
 static void
-_Set_expand(struct Set* s)
+_swiss_set_ctrl(struct Set* s, size_t idx, uint8_t tag)
 {
-  struct SetItem* old_table = s->table;
-  size_t old_capacity = s->capacity;
-  s->table = calloc(s->capacity * 2, sizeof(struct SetItem));
-  s->capacity *= 2;
-  s->load = 0;
+  s->ctrl[idx] = tag;
+
+  // The first group is mirrored after the end so loads never wrap
+  if (idx < SWISS_GROUP_WIDTH) {
+    s->ctrl[s->capacity + idx] = tag;
+  }
+}
 
-  for (size_t i = 0; i < old_capacity; i++) {
-    struct SetItem* old_item = &old_table[i];
-    if (old_table[i].key != NULL) {
-      size_t idx = fnv_1a_hash(old_item->key, old_item->key_len) % s->capacity;
-
-      for (size_t j = 0; j < s->capacity; j++) {
-        struct SetItem* item = &s->table[(idx + j) % s->capacity];
-        if (item->key == NULL) {
-          item->key = old_item->key;
-          item->key_len = old_item->key_len;
-          s->load += 1;
-          break;
-        }
+static struct SetItem*
+_Set_swiss_find(struct Set* s, uint64_t hash, char* key, size_t key_len)
+{
+  size_t mask = s->capacity - 1;
+  size_t pos = (size_t)(hash >> 7) & mask;
+  uint8_t tag = _swiss_tag(hash);
+
+  for (size_t stride = 0; stride <= s->capacity;) {
+    const uint8_t* group = &s->ctrl[pos];
+
+    unsigned int match = _swiss_match(group, tag);
+    while (match != 0) {
+      struct SetItem* item =
+        _Set_item(s, (pos + _swiss_lowest_bit(match)) & mask);
+      if (_SetItem_matches(item, hash, key, key_len)) {
+        return item;
       }
+      match &= match - 1;
+    }
+
+    if (_swiss_match(group, SWISS_EMPTY) != 0) {
+      return NULL;
     }
+
+    stride += SWISS_GROUP_WIDTH;
+    pos = (pos + stride) & mask;
   }
+
+  return NULL;
 }
 
-void
-Set_put(struct Set* s, char* key, size_t key_len)
+/*
+ * Claims the first empty or deleted slot on the key's probe sequence. The
+ * key must not already be in the table.
+ */
+static struct SetItem*
+_Set_swiss_insert(struct Set* s, uint64_t hash)
 {
-  assert(key_len != 0);
+  size_t mask = s->capacity - 1;
+  size_t pos = (size_t)(hash >> 7) & mask;
+
+  for (size_t stride = 0;;) {
+    unsigned int free_mask = _swiss_match_free(&s->ctrl[pos]);
+    if (free_mask != 0) {
+      size_t idx = (pos + _swiss_lowest_bit(free_mask)) & mask;
+      if (s->ctrl[idx] == SWISS_DELETED) {
+        s->deleted -= 1;
+      }
+      _swiss_set_ctrl(s, idx, _swiss_tag(hash));
+
+      struct SetItem* item = _Set_item(s, idx);
+      item->hash = hash;
+      return item;
+    }
 
-  if ((float)s->load / s->capacity > 0.75) {
-    _Set_expand(s);
+    stride += SWISS_GROUP_WIDTH;
+    pos = (pos + stride) & mask;
   }
+}
 
-  size_t idx = fnv_1a_hash(key, key_len) % s->capacity;
+static struct SetItem*
+_Set_linear_find(struct Set* s, uint64_t hash, char* key, size_t key_len)
+{
+  size_t idx = _Set_home(s, hash);
 
-  for (size_t i = 0; i < s->capacity; i++) {
-    struct SetItem* item = &s->table[(idx + i) % s->capacity];
+  for (size_t i = 0; i < s->capacity; i++, idx = _Set_next(s, idx)) {
+    struct SetItem* item = _Set_item(s, idx);
     if (item->key == NULL) {
-      char* key_copy = malloc(key_len);
-      memcpy(key_copy, key, key_len);
+      return NULL;
+    } else if (_SetItem_matches(item, hash, key, key_len)) {
+      return item;
+    }
+  }
 
-      item->key = key_copy;
-      item->key_len = key_len;
+  return NULL;
+}
 
-      s->load += 1;
-      return;
-    } else if (_key_cmp(item->key, item->key_len, key, key_len) == 0) {
-      return;
+/*
+ * Entries along a Robin Hood probe sequence never sit closer to their home
+ * than the key being searched for, so a miss ends at the first entry whose
+ * probe distance is shorter than the current one.
+ */
+static struct SetItem*
+_Set_robin_hood_find(struct Set* s, uint64_t hash, char* key, size_t key_len)
+{
+  size_t idx = _Set_home(s, hash);
+
+  for (size_t i = 0; i < s->capacity; i++, idx = _Set_next(s, idx)) {
+    struct SetItem* item = _Set_item(s, idx);
+    if (item->key == NULL || item->dist < i) {
+      return NULL;
+    } else if (_SetItem_matches(item, hash, key, key_len)) {
+      return item;
     }
   }
+
+  return NULL;
 }
 
-void
-Set_delete(struct Set* s, char* key, size_t key_len)
+/*
+ * Places an entry and its value, starting at slot idx with its probe
+ * distance already set, by swapping it with any entry that is closer to its
+ * own home. Returns the slot the entry ended up in.
+ */
+static struct SetItem*
+_Set_robin_hood_place(struct Set* s,
+                      size_t idx,
+                      struct SetItem entry,
+                      void* value)
 {
-  assert(key_len != 0);
+  struct SetItem* placed = NULL;
 
-  size_t hash_idx = fnv_1a_hash(key, key_len) % s->capacity;
-
-  int has_item = 0;
-  size_t delete_idx;
-  for (size_t i = 0; i < s->capacity; i++) {
-    struct SetItem* item = &s->table[(hash_idx + i) % s->capacity];
+  for (size_t i = 0; i < s->capacity; i++, idx = _Set_next(s, idx)) {
+    struct SetItem* item = _Set_item(s, idx);
     if (item->key == NULL) {
-      return;
-    } else if (_key_cmp(item->key, item->key_len, key, key_len) == 0) {
-      free(item->key);
-      item->key = NULL;
+      _SetItem_move(item, &entry);
+      _Set_set_value(s, item, value);
+      return placed != NULL ? placed : item;
+    } else if (item->dist < entry.dist) {
+      struct SetItem displaced;
+      _SetItem_move(&displaced, item);
+      _SetItem_move(item, &entry);
+      _SetItem_move(&entry, &displaced);
 
-      s->load -= 1;
+      void* displaced_value = _Set_value(s, item);
+      _Set_set_value(s, item, value);
+      value = displaced_value;
 
-      delete_idx = (hash_idx + i) % s->capacity;
-      has_item = 0;
-      break;
+      if (placed == NULL) {
+        placed = item;
+      }
     }
+    entry.dist += 1;
   }
-  if (!has_item)
+
+  return placed;
+}
+
+static struct SetItem*
+_Set_find(struct Set* s, uint64_t hash, char* key, size_t key_len)
+{
+  if (s->flags & SET_SWISS_TABLE) {
+    return _Set_swiss_find(s, hash, key, key_len);
+  } else if (s->flags & SET_ROBIN_HOOD) {
+    return _Set_robin_hood_find(s, hash, key, key_len);
+  }
+
+  return _Set_linear_find(s, hash, key, key_len);
+}
+
+/*
+ * Starts loading the first memory a lookup of the hash will touch.
+ */
+static inline void
+_Set_prefetch(const struct Set* s, uint64_t hash)
+{
+  if (s->flags & SET_SWISS_TABLE) {
+    size_t pos = (size_t)(hash >> 7) & (s->capacity - 1);
+    SET_PREFETCH(&s->ctrl[pos]);
+    SET_PREFETCH(_Set_item(s, pos));
     return;
+  }
 
-  size_t replace_idx = delete_idx;
-  for (size_t i = 0; i < s->capacity - (replace_idx - hash_idx); i++) {
-    struct SetItem* item = &s->table[(delete_idx + i) % s->capacity];
-    if (item->key == NULL) {
-      return;
-    } else if (fnv_1a_hash(item->key, item->key_len) % s->capacity <=
-               hash_idx) {
-      s->table[replace_idx].key = item->key;
-      s->table[replace_idx].key_len = item->key_len;
+  SET_PREFETCH(_Set_item(s, _Set_home(s, hash)));
+}
 
-      item->key = NULL;
+/*
+ * Places an entry and its value whose key is not in the table yet.
+ */
+static struct SetItem*
+_Set_place(struct Set* s, struct SetItem entry, void* value)
+{
+  if (s->flags & SET_SWISS_TABLE) {
+    struct SetItem* item = _Set_swiss_insert(s, entry.hash);
+    _SetItem_move(item, &entry);
+    _Set_set_value(s, item, value);
+    return item;
+  } else if (s->flags & SET_ROBIN_HOOD) {
+    entry.dist = 0;
+    return _Set_robin_hood_place(s, _Set_home(s, entry.hash), entry, value);
+  }
 
-      replace_idx = (delete_idx + i) % s->capacity;
+  size_t idx = _Set_home(s, entry.hash);
+  for (size_t i = 0; i < s->capacity; i++, idx = _Set_next(s, idx)) {
+    struct SetItem* item = _Set_item(s, idx);
+    if (item->key == NULL) {
+      _SetItem_move(item, &entry);
+      _Set_set_value(s, item, value);
+      return item;
     }
   }
+
+  return NULL;
 }
 
-struct Set*
-Set_union(struct Set* s_a, struct Set* s_b)
+/*
+ * Copies a key into a new entry, allocating long keys from arena when it is
+ * not NULL.
+ */
+static struct SetItem
+_SetItem_copy_key_to(struct Arena* arena,
+                     char* key,
+                     size_t key_len,
+                     uint64_t hash)
 {
-  struct Set* union_s = Set_new(s_a->capacity + s_b->capacity);
+  struct SetItem entry = { .key_len = key_len, .hash = hash, .dist = 0 };
 
-  for (size_t i = 0; i < s_a->capacity; i++) {
-    if (s_a->table[i].key != NULL) {
-      Set_put(union_s, s_a->table[i].key, s_a->table[i].key_len);
+  // Short keys live in the slot itself, only long keys are allocated
+  if (_SetItem_is_inline(&entry)) {
+    entry.key = entry.inline_key;
+  } else if (arena != NULL) {
+    entry.key = Arena_alloc(arena, key_len);
+  } else {
+    entry.key = malloc(key_len);
+  }
+  memcpy(entry.key, key, key_len);
+
+  return entry;
+}
+
+static inline struct SetItem
+_SetItem_copy_key(struct Set* s, char* key, size_t key_len, uint64_t hash)
+{
+  return _SetItem_copy_key_to(s->arena, key, key_len, hash);
+}
+
+/*
+ * Walks the key's probe sequence once, returning the slot that holds the key
+ * or, when it is missing, the slot a copy of it was placed in.
+ */
+static struct SetItem*
+_Set_find_or_insert(struct Set* s,
+                    uint64_t hash,
+                    char* key,
+                    size_t key_len,
+                    int* inserted)
+{
+  *inserted = 0;
+
+  if (s->flags & SET_SWISS_TABLE) {
+    struct SetItem* item = _Set_swiss_find(s, hash, key, key_len);
+    if (item == NULL) {
+      item = _Set_place(s, _SetItem_copy_key(s, key, key_len, hash), NULL);
+      *inserted = 1;
     }
+    return item;
   }
-  for (size_t i = 0; i < s_b->capacity; i++) {
-    if (s_b->table[i].key != NULL) {
-      Set_put(union_s, s_b->table[i].key, s_b->table[i].key_len);
+
+  int robin_hood = (s->flags & SET_ROBIN_HOOD) != 0;
+  size_t idx = _Set_home(s, hash);
+
+  for (size_t i = 0; i < s->capacity; i++, idx = _Set_next(s, idx)) {
+    struct SetItem* item = _Set_item(s, idx);
+    if (item->key == NULL || (robin_hood && item->dist < i)) {
+      struct SetItem entry = _SetItem_copy_key(s, key, key_len, hash);
+      entry.dist = (uint32_t)i;
+
+      *inserted = 1;
+      if (robin_hood) {
+        return _Set_robin_hood_place(s, idx, entry, NULL);
+      }
+
+      _SetItem_move(item, &entry);
+      _Set_set_value(s, item, NULL);
+      return item;
+    } else if (_SetItem_matches(item, hash, key, key_len)) {
+      return item;
     }
   }
 
-  return union_s;
+  return NULL;
 }
 
-struct Set*
-Set_intersection(struct Set* s_a, struct Set* s_b)
+/*
+ * Closes the hole left at idx by a removed entry. Linear probing moves each
+ * following entry back unless its home lies between the hole and its slot,
+ * Robin Hood moves entries back until one is already at its home.
+ */
+static void
+_Set_backward_shift(struct Set* s, size_t hole)
 {
-  struct Set* intersection_s = Set_new(s_a->capacity + s_b->capacity);
+  int robin_hood = (s->flags & SET_ROBIN_HOOD) != 0;
+  size_t idx = _Set_next(s, hole);
 
-  for (size_t i = 0; i < s_a->capacity; i++) {
-    if (s_a->table[i].key != NULL &&
-        Set_has(s_b, s_a->table[i].key, s_a->table[i].key_len)) {
-      Set_put(intersection_s, s_a->table[i].key, s_a->table[i].key_len);
+  for (size_t i = 1; i < s->capacity; i++, idx = _Set_next(s, idx)) {
+    struct SetItem* item = _Set_item(s, idx);
+    if (item->key == NULL || (robin_hood && item->dist == 0)) {
+      return;
+    }
+
+    int move = 1;
+    if (!robin_hood) {
+      size_t home = _Set_home(s, item->hash);
+      move = hole <= idx ? (home <= hole || home > idx)
+                         : (home <= hole && home > idx);
+    }
+
+    if (move) {
+      struct SetItem* dst = _Set_item(s, hole);
+      _SetItem_move(dst, item);
+      dst->dist = robin_hood ? item->dist - 1 : 0;
+      _Set_set_value(s, dst, _Set_value(s, item));
+
+      item->key = NULL;
+      hole = idx;
     }
   }
+}
 
-  return intersection_s;
+static void
+_Set_remove(struct Set* s, struct SetItem* item)
+{
+  item->key = NULL;
+
+  if (s->flags & SET_SWISS_TABLE) {
+    _swiss_set_ctrl(s, _Set_index(s, item), SWISS_DELETED);
+    s->deleted += 1;
+  } else {
+    _Set_backward_shift(s, _Set_index(s, item));
+  }
 }
 
-struct SetIterator*
-SetIterator_new(struct Set* s)
+/*
+ * Looks a key up in both tables while an incremental resize is in progress.
+ */
+static struct SetItem*
+_Set_lookup(struct Set* s, uint64_t hash, char* key, size_t key_len)
+{
+  struct SetItem* item = _Set_find(s, hash, key, key_len);
+  if (item == NULL && s->resize_from != NULL) {
+    item = _Set_find(s->resize_from, hash, key, key_len);
+  }
+
+  return item;
+}
+
+/*
+ * Moves the entries of up to steps slots of the old table into the new one,
+ * freeing the old table once every slot has been visited.
+ */
+static void
+_Set_migrate(struct Set* s, size_t steps)
+{
+  struct Set* old = s->resize_from;
+  if (old == NULL) {
+    return;
+  }
+
+  for (size_t i = 0; i < steps && s->resize_idx < old->capacity; i++) {
+    struct SetItem* item = _Set_item(old, s->resize_idx);
+    if (item->key == NULL) {
+      s->resize_idx += 1;
+      continue;
+    }
+
+    // Backward shifting can pull the next entry into this slot, so it is
+    // only passed over once it is empty. The slots before it stay empty,
+    // keeping the old table a valid table for lookups and deletes.
+    _Set_place(s, *item, _Set_value(old, item));
+    _Set_remove(old, item);
+    old->load -= 1;
+  }
+
+  if (s->resize_idx == old->capacity) {
+    free(old->ctrl);
+    free(old->table);
+    free(old);
+
+    s->resize_from = NULL;
+  }
+}
+
+/*
+ * Moves every entry into a table of the given capacity, either at once or,
+ * with SET_INCREMENTAL_RESIZE, a few slots per operation.
+ */
+static void
+_Set_resize(struct Set* s, size_t capacity)
 {
+  if (s->flags & SET_INCREMENTAL_RESIZE) {
+    _Set_migrate(s, SIZE_MAX);
+
+    struct Set* old = malloc(sizeof(struct Set));
+    *old = *s;
+    old->arena = NULL;
+
+    _Set_alloc_table(s, capacity);
+    s->resize_from = old;
+    s->resize_idx = 0;
+    return;
+  }
+
+  struct Set old = *s;
+
+  _Set_alloc_table(s, capacity);
+
+  for (size_t i = 0; i < old.capacity; i++) {
+    struct SetItem* item = _Set_item(&old, i);
+    if (item->key != NULL) {
+      _Set_place(s, *item, _Set_value(&old, item));
+    }
+  }
+
+  free(old.ctrl);
+  free(old.table);
+}
+
+static void
+_Set_reserve(struct Set* s)
+{
+  if (s->flags & SET_SWISS_TABLE) {
+    // Deleted slots still lengthen probes, so they count towards the load
+    if ((s->load + s->deleted + 1) * 8 <= s->capacity * 7) {
+      return;
+    }
+
+    // Mostly tombstones, rebuild at the same size to reclaim them
+    _Set_resize(s, s->load * 2 < s->capacity ? s->capacity : s->capacity * 2);
+    return;
+  }
+
+  // Robin Hood checks the load the insert would leave, so the table never
+  // passes its limit
+  if (s->flags & SET_ROBIN_HOOD) {
+    if ((float)(s->load + 1) / s->capacity > SET_ROBIN_HOOD_MAX_LOAD) {
+      _Set_resize(s, s->capacity * 2);
+    }
+    return;
+  }
+
+  if ((float)s->load / s->capacity > SET_MAX_LOAD) {
+    _Set_resize(s, s->capacity * 2);
+  }
+}
+
+int
+Set_has(struct Set* s, char* key, size_t key_len)
+{
+  assert(key_len > 0);
+
+  return Set_has_hashed(s, key, key_len, s->hash(key, key_len, s->seed));
+}
+
+int
+Set_has_hashed(struct Set* s, char* key, size_t key_len, uint64_t hash)
+{
+  assert(key_len > 0);
+
+  _Set_migrate(s, SET_RESIZE_STEPS);
+
+  return _Set_lookup(s, hash, key, key_len) != NULL;
+}
+
+struct SetItem*
+Set_get(struct Set* s, char* key, size_t key_len)
+{
+  assert(key_len > 0);
+
+  _Set_migrate(s, SET_RESIZE_STEPS);
+
+  uint64_t hash = s->hash(key, key_len, s->seed);
+
+  return _Set_lookup(s, hash, key, key_len);
+}
+
+struct SetItem*
+Set_put(struct Set* s, char* key, size_t key_len)
+{
+  int inserted;
+
+  return Set_insert_or_find(s, key, key_len, &inserted);
+}
+
+struct SetItem*
+Set_insert_or_find(struct Set* s, char* key, size_t key_len, int* inserted)
+{
+  assert(key_len != 0);
+
+  uint64_t hash = s->hash(key, key_len, s->seed);
+
+  return Set_insert_or_find_hashed(s, key, key_len, hash, inserted);
+}
+
+struct SetItem*
+Set_insert_or_find_hashed(struct Set* s,
+                          char* key,
+                          size_t key_len,
+                          uint64_t hash,
+                          int* inserted)
+{
+  assert(key_len != 0);
+
+  _Set_reserve(s);
+  _Set_migrate(s, SET_RESIZE_STEPS);
+
+  if (s->resize_from != NULL) {
+    struct SetItem* item = _Set_find(s->resize_from, hash, key, key_len);
+    if (item != NULL) {
+      *inserted = 0;
+      return item;
+    }
+  }
+
+  struct SetItem* item = _Set_find_or_insert(s, hash, key, key_len, inserted);
+  if (*inserted) {
+    s->load += 1;
+  }
+
+  return item;
+}
+
+void
+Set_has_batch(struct Set* s,
+              char** keys,
+              size_t* key_lens,
+              size_t n,
+              int* results)
+{
+  uint64_t hashes[SET_BATCH_SIZE];
+
+  for (size_t start = 0; start < n; start += SET_BATCH_SIZE) {
+    size_t count = n - start < SET_BATCH_SIZE ? n - start : SET_BATCH_SIZE;
+
+    _Set_migrate(s, SET_RESIZE_STEPS * count);
+
+    // Hash the whole group and request its slots before probing any of
+    // them, so the cache misses overlap instead of queueing one by one
+    hash_many(s->hash, s->seed, keys + start, key_lens + start, count, hashes);
+    for (size_t i = 0; i < count; i++) {
+      assert(key_lens[start + i] > 0);
+
+      _Set_prefetch(s, hashes[i]);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      results[start + i] =
+        _Set_lookup(s, hashes[i], keys[start + i], key_lens[start + i]) !=
+        NULL;
+    }
+  }
+}
+
+size_t
+Set_put_batch(struct Set* s, char** keys, size_t* key_lens, size_t n)
+{
+  uint64_t hashes[SET_BATCH_SIZE];
+  size_t added = 0;
+
+  for (size_t start = 0; start < n; start += SET_BATCH_SIZE) {
+    size_t count = n - start < SET_BATCH_SIZE ? n - start : SET_BATCH_SIZE;
+
+    hash_many(s->hash, s->seed, keys + start, key_lens + start, count, hashes);
+    for (size_t i = 0; i < count; i++) {
+      assert(key_lens[start + i] > 0);
+
+      _Set_prefetch(s, hashes[i]);
+    }
+
+    // A resize part way through only makes the later prefetches useless,
+    // every insert still goes through the normal path
+    for (size_t i = 0; i < count; i++) {
+      int inserted;
+      Set_insert_or_find_hashed(
+        s, keys[start + i], key_lens[start + i], hashes[i], &inserted);
+      added += (size_t)inserted;
+    }
+  }
+
+  return added;
+}
+
+void
+Set_delete(struct Set* s, char* key, size_t key_len)
+{
+  assert(key_len != 0);
+
+  Set_delete_hashed(s, key, key_len, s->hash(key, key_len, s->seed));
+}
+
+/*
+ * Removes the key from whichever table holds it, returning its value.
+ */
+static void*
+_Set_delete(struct Set* s, char* key, size_t key_len, uint64_t hash)
+{
+  _Set_migrate(s, SET_RESIZE_STEPS);
+
+  struct Set* table = s;
+  struct SetItem* item = _Set_find(s, hash, key, key_len);
+  if (item == NULL && s->resize_from != NULL) {
+    table = s->resize_from;
+    item = _Set_find(table, hash, key, key_len);
+  }
+  if (item == NULL) {
+    return NULL;
+  }
+
+  void* value = _Set_value(table, item);
+  _SetItem_free_key(s, item);
+  _Set_remove(table, item);
+
+  table->load -= 1;
+  if (table != s) {
+    s->load -= 1;
+  }
+
+  return value;
+}
+
+void
+Set_delete_hashed(struct Set* s, char* key, size_t key_len, uint64_t hash)
+{
+  assert(key_len != 0);
+
+  _Set_delete(s, key, key_len, hash);
+}
+
+void*
+Set_delete_value(struct Set* s, char* key, size_t key_len)
+{
+  assert(key_len != 0);
+  assert(s->flags & SET_VALUES);
+
+  return _Set_delete(s, key, key_len, s->hash(key, key_len, s->seed));
+}
+
+void**
+Set_value(struct Set* s, struct SetItem* item)
+{
+  assert(s->flags & SET_VALUES);
+
+  return &((struct SetValueItem*)item)->value;
+}
+
+/*
+ * Whether a table of the given capacity holds load entries without growing.
+ */
+static int
+_Set_fits(unsigned int flags, size_t capacity, size_t load)
+{
+  if (flags & SET_SWISS_TABLE) {
+    return load * 8 <= capacity * 7;
+  }
+
+  float max_load =
+    (flags & SET_ROBIN_HOOD) ? SET_ROBIN_HOOD_MAX_LOAD : SET_MAX_LOAD;
+  return (float)load / capacity <= max_load;
+}
+
+/*
+ * Creates an empty set with the options of s, sized to take load entries
+ * without resizing.
+ */
+static struct Set*
+_Set_new_like(struct Set* s, size_t load)
+{
+  size_t capacity = SWISS_GROUP_WIDTH;
+  while (!_Set_fits(s->flags, capacity, load)) {
+    capacity *= 2;
+  }
+
+  return Set_new_with_options(capacity, s->flags, s->hash, s->seed);
+}
+
+/*
+ * Finishes any migration and grows the table once so it takes load entries
+ * without resizing again.
+ */
+static void
+_Set_reserve_for(struct Set* s, size_t load)
+{
+  _Set_migrate(s, SIZE_MAX);
+
+  size_t capacity = s->capacity;
+  while (!_Set_fits(s->flags, capacity, load)) {
+    capacity *= 2;
+  }
+
+  if (capacity != s->capacity ||
+      !_Set_fits(s->flags, capacity, load + s->deleted)) {
+    _Set_resize(s, capacity);
+    _Set_migrate(s, SIZE_MAX);
+  }
+}
+
+/*
+ * Hash of an item of from under the hash function of s. Items cache the hash
+ * of their own set, which is reused when both sets hash the same way.
+ */
+static inline uint64_t
+_Set_hash_item(const struct Set* s,
+               const struct Set* from,
+               const struct SetItem* item)
+{
+  if (s->hash == from->hash && s->seed == from->seed) {
+    return item->hash;
+  }
+
+  return s->hash(item->key, item->key_len, s->seed);
+}
+
+static inline struct SetItem*
+_Set_lookup_item(struct Set* s,
+                 const struct Set* from,
+                 const struct SetItem* item)
+{
+  return _Set_lookup(
+    s, _Set_hash_item(s, from, item), item->key, item->key_len);
+}
+
+static inline void
+_Set_add_item(struct Set* s,
+              const struct Set* from,
+              const struct SetItem* item,
+              void* value)
+{
+  int inserted;
+  struct SetItem* added = Set_insert_or_find_hashed(
+    s, item->key, item->key_len, _Set_hash_item(s, from, item), &inserted);
+  if (inserted) {
+    _Set_set_value(s, added, value);
+  }
+}
+
+void
+Set_finish_resize(struct Set* s)
+{
+  _Set_migrate(s, SIZE_MAX);
+}
+
+struct Set*
+Set_copy(struct Set* s)
+{
+  _Set_migrate(s, SIZE_MAX);
+
+  struct Set* copy = malloc(sizeof(struct Set));
+  *copy = *s;
+
+  copy->table = malloc(s->capacity * s->item_size);
+  memcpy(copy->table, s->table, s->capacity * s->item_size);
+
+  if (s->ctrl != NULL) {
+    copy->ctrl = malloc(s->capacity + SWISS_GROUP_WIDTH);
+    memcpy(copy->ctrl, s->ctrl, s->capacity + SWISS_GROUP_WIDTH);
+  }
+
+  copy->arena = NULL;
+  if (s->flags & SET_ARENA_KEYS) {
+    copy->arena = Arena_new(SET_ARENA_CHUNK_SIZE);
+  }
+
+  // The slots keep their positions, only the keys need their own storage
+  for (size_t i = 0; i < copy->capacity; i++) {
+    struct SetItem* item = _Set_item(copy, i);
+    if (item->key == NULL) {
+      continue;
+    }
+
+    struct SetItem entry =
+      _SetItem_copy_key(copy, item->key, item->key_len, item->hash);
+    entry.dist = item->dist;
+    _SetItem_move(item, &entry);
+  }
+
+  return copy;
+}
+
+struct Set*
+Set_union(struct Set* s_a, struct Set* s_b)
+{
+  _Set_migrate(s_a, SIZE_MAX);
+  _Set_migrate(s_b, SIZE_MAX);
+
+  struct Set* union_s = _Set_new_like(s_a, s_a->load + s_b->load);
+
+  for (size_t i = 0; i < s_a->capacity; i++) {
+    struct SetItem* item = _Set_item(s_a, i);
+    if (item->key != NULL) {
+      _Set_add_item(union_s, s_a, item, _Set_value(s_a, item));
+    }
+  }
+  for (size_t i = 0; i < s_b->capacity; i++) {
+    struct SetItem* item = _Set_item(s_b, i);
+    if (item->key != NULL) {
+      _Set_add_item(union_s, s_b, item, _Set_value(s_b, item));
+    }
+  }
+
+  return union_s;
+}
+
+struct Set*
+Set_intersection(struct Set* s_a, struct Set* s_b)
+{
+  _Set_migrate(s_a, SIZE_MAX);
+  _Set_migrate(s_b, SIZE_MAX);
+
+  // Walk the smaller table and probe the larger one
+  struct Set* small = s_a->load <= s_b->load ? s_a : s_b;
+  struct Set* large = small == s_a ? s_b : s_a;
+
+  struct Set* intersection_s = _Set_new_like(s_a, small->load);
+
+  for (size_t i = 0; i < small->capacity; i++) {
+    struct SetItem* item = _Set_item(small, i);
+    if (item->key == NULL) {
+      continue;
+    }
+
+    struct SetItem* found = _Set_lookup_item(large, small, item);
+    if (found != NULL) {
+      struct SetItem* item_a = small == s_a ? item : found;
+      _Set_add_item(intersection_s, small, item, _Set_value(s_a, item_a));
+    }
+  }
+
+  return intersection_s;
+}
+
+struct Set*
+Set_difference(struct Set* s_a, struct Set* s_b)
+{
+  _Set_migrate(s_a, SIZE_MAX);
+
+  struct Set* difference_s = _Set_new_like(s_a, s_a->load);
+
+  for (size_t i = 0; i < s_a->capacity; i++) {
+    struct SetItem* item = _Set_item(s_a, i);
+    if (item->key != NULL && _Set_lookup_item(s_b, s_a, item) == NULL) {
+      _Set_add_item(difference_s, s_a, item, _Set_value(s_a, item));
+    }
+  }
+
+  return difference_s;
+}
+
+struct Set*
+Set_symmetric_difference(struct Set* s_a, struct Set* s_b)
+{
+  _Set_migrate(s_a, SIZE_MAX);
+  _Set_migrate(s_b, SIZE_MAX);
+
+  struct Set* difference_s = _Set_new_like(s_a, s_a->load + s_b->load);
+
+  for (size_t i = 0; i < s_a->capacity; i++) {
+    struct SetItem* item = _Set_item(s_a, i);
+    if (item->key != NULL && _Set_lookup_item(s_b, s_a, item) == NULL) {
+      _Set_add_item(difference_s, s_a, item, _Set_value(s_a, item));
+    }
+  }
+  for (size_t i = 0; i < s_b->capacity; i++) {
+    struct SetItem* item = _Set_item(s_b, i);
+    if (item->key != NULL && _Set_lookup_item(s_a, s_b, item) == NULL) {
+      _Set_add_item(difference_s, s_b, item, _Set_value(s_b, item));
+    }
+  }
+
+  return difference_s;
+}
+
+int
+Set_is_subset(struct Set* s_a, struct Set* s_b)
+{
+  if (s_a->load > s_b->load) {
+    return 0;
+  }
+
+  _Set_migrate(s_a, SIZE_MAX);
+
+  for (size_t i = 0; i < s_a->capacity; i++) {
+    struct SetItem* item = _Set_item(s_a, i);
+    if (item->key != NULL && _Set_lookup_item(s_b, s_a, item) == NULL) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+void
+Set_union_in_place(struct Set* s_a, struct Set* s_b)
+{
+  if (s_a == s_b) {
+    return;
+  }
+
+  _Set_migrate(s_b, SIZE_MAX);
+  _Set_reserve_for(s_a, s_a->load + s_b->load);
+
+  for (size_t i = 0; i < s_b->capacity; i++) {
+    struct SetItem* item = _Set_item(s_b, i);
+    if (item->key != NULL) {
+      _Set_add_item(s_a, s_b, item, _Set_value(s_b, item));
+    }
+  }
+}
+
+void
+Set_union_consume(struct Set* s_a, struct Set* s_b)
+{
+  assert(s_a != s_b);
+
+  _Set_migrate(s_b, SIZE_MAX);
+  _Set_reserve_for(s_a, s_a->load + s_b->load);
+
+  // Keys can only change hands when both sets release them the same way,
+  // otherwise they are copied into storage owned by s_a
+  int move = (s_a->arena == NULL) == (s_b->arena == NULL);
+
+  for (size_t i = 0; i < s_b->capacity; i++) {
+    struct SetItem* item = _Set_item(s_b, i);
+    if (item->key == NULL) {
+      continue;
+    }
+
+    uint64_t hash = _Set_hash_item(s_a, s_b, item);
+    if (_Set_find(s_a, hash, item->key, item->key_len) != NULL) {
+      _SetItem_free_key(s_b, item);
+      continue;
+    }
+
+    struct SetItem entry = *item;
+    if (!move) {
+      entry = _SetItem_copy_key(s_a, item->key, item->key_len, hash);
+      _SetItem_free_key(s_b, item);
+    }
+    entry.hash = hash;
+
+    _Set_place(s_a, entry, _Set_value(s_b, item));
+    s_a->load += 1;
+  }
+
+  if (move && s_b->arena != NULL) {
+    Arena_merge(s_a->arena, s_b->arena);
+  } else if (s_b->arena != NULL) {
+    Arena_free(s_b->arena);
+  }
+
+  free(s_b->ctrl);
+  free(s_b->table);
+  free(s_b);
+}
+
+/*
+ * An input item bound for a parallel result, with its hash under the hash
+ * function of the result.
+ */
+struct _SetRef
+{
+  const struct SetItem* item;
+  uint64_t hash;
+};
+
+struct _SetRefs
+{
+  struct _SetRef* refs;
+  size_t length;
+  size_t capacity;
+};
+
+static inline void
+_SetRefs_push(struct _SetRefs* r, const struct SetItem* item, uint64_t hash)
+{
+  if (r->length == r->capacity) {
+    r->capacity = r->capacity == 0 ? 16 : r->capacity * 2;
+    r->refs = realloc(r->refs, r->capacity * sizeof(struct _SetRef));
+  }
+
+  r->refs[r->length++] = (struct _SetRef){ .item = item, .hash = hash };
+}
+
+/*
+ * Entries that could not be placed by their part, with their values.
+ */
+struct _SetDeferred
+{
+  struct SetValueItem* entries;
+  size_t length;
+  size_t capacity;
+};
+
+static void
+_SetDeferred_push(struct _SetDeferred* d, struct SetItem* entry, void* value)
+{
+  if (d->length == d->capacity) {
+    d->capacity = d->capacity == 0 ? 16 : d->capacity * 2;
+    d->entries = realloc(d->entries, d->capacity * sizeof(struct SetValueItem));
+  }
+
+  d->entries[d->length++] = (struct SetValueItem){ .item = *entry,
+                                                   .value = value };
+}
+
+/*
+ * Keys of s that go into a parallel result. Without probe every key is
+ * taken, otherwise only those found in probe, or missing from it without
+ * want_found. With from_probe the matching item of probe is taken instead.
+ */
+struct _SetSource
+{
+  struct Set* s;
+  struct Set* probe;
+  int want_found;
+  int from_probe;
+};
+
+/*
+ * A result table built in parts. Each key belongs to the part its probe
+ * sequence starts in. Every source is scanned in parts chunks, each chunk
+ * sorting the keys it takes into its own row of buckets, one per part. Each
+ * part then places the keys of its column while only touching its own
+ * slots, deferring keys whose probe sequence would leave the part to the
+ * calling thread.
+ */
+struct _SetBuild
+{
+  struct Set* out;
+  const struct _SetSource* sources;
+  size_t source_count;
+  size_t parts;
+  size_t part_size;
+  struct _SetRefs* buckets;
+  struct _SetDeferred* deferred;
+  struct Arena** arenas;
+};
+
+static inline size_t
+_Set_part(const struct _SetBuild* b, uint64_t hash)
+{
+  const struct Set* s = b->out;
+  if (s->flags & SET_SWISS_TABLE) {
+    return ((size_t)(hash >> 7) & (s->capacity - 1)) / b->part_size;
+  }
+
+  return _Set_home(s, hash) / b->part_size;
+}
+
+/*
+ * The set whose items a source puts in the result.
+ */
+static inline const struct Set*
+_SetSource_owner(const struct _SetSource* source)
+{
+  return source->from_probe ? source->probe : source->s;
+}
+
+static void
+_Set_build_scan(struct _SetBuild* b, size_t task)
+{
+  const struct _SetSource* source = &b->sources[task / b->parts];
+  struct Set* s = source->s;
+  size_t chunk = task % b->parts;
+  struct _SetRefs* row = &b->buckets[task * b->parts];
+
+  // Size the buckets for an even spread of the chunk's keys
+  size_t expected = s->load / (b->parts * b->parts);
+  for (size_t p = 0; p < b->parts; p++) {
+    row[p].capacity = expected + expected / 4 + 16;
+    row[p].refs = malloc(row[p].capacity * sizeof(struct _SetRef));
+  }
+
+  // Only reads the inputs, so any number of chunks can scan them at once
+  size_t end = s->capacity * (chunk + 1) / b->parts;
+  for (size_t i = s->capacity * chunk / b->parts; i < end; i++) {
+    struct SetItem* item = _Set_item(s, i);
+    if (item->key == NULL) {
+      continue;
+    }
+
+    if (source->probe != NULL) {
+      struct SetItem* found = _Set_lookup_item(source->probe, s, item);
+      if ((found != NULL) != source->want_found) {
+        continue;
+      }
+      if (source->from_probe) {
+        item = found;
+      }
+    }
+
+    uint64_t hash = _Set_hash_item(b->out, _SetSource_owner(source), item);
+    _SetRefs_push(&row[_Set_part(b, hash)], item, hash);
+  }
+}
+
+/*
+ * Places an entry whose probe sequence starts in [lo, hi) without touching
+ * slots outside it. Returns 0 when the sequence would leave the range,
+ * leaving in entry and value the one still to be placed, which with Robin
+ * Hood may be an entry it displaced.
+ */
+static int
+_Set_place_in_range(struct Set* s,
+                    struct SetItem* entry,
+                    void** value,
+                    size_t lo,
+                    size_t hi)
+{
+  if (s->flags & SET_SWISS_TABLE) {
+    size_t mask = s->capacity - 1;
+    size_t pos = (size_t)(entry->hash >> 7) & mask;
+
+    for (size_t stride = 0; pos >= lo && pos + SWISS_GROUP_WIDTH <= hi;) {
+      unsigned int free_mask = _swiss_match_free(&s->ctrl[pos]);
+      if (free_mask != 0) {
+        size_t idx = pos + _swiss_lowest_bit(free_mask);
+        _swiss_set_ctrl(s, idx, _swiss_tag(entry->hash));
+
+        struct SetItem* item = _Set_item(s, idx);
+        _SetItem_move(item, entry);
+        _Set_set_value(s, item, *value);
+        return 1;
+      }
+
+      stride += SWISS_GROUP_WIDTH;
+      pos = (pos + stride) & mask;
+    }
+
+    return 0;
+  }
+
+  int robin_hood = (s->flags & SET_ROBIN_HOOD) != 0;
+  entry->dist = 0;
+
+  for (size_t idx = _Set_home(s, entry->hash); idx < hi; idx++) {
+    struct SetItem* item = _Set_item(s, idx);
+    if (item->key == NULL) {
+      _SetItem_move(item, entry);
+      _Set_set_value(s, item, *value);
+      return 1;
+    } else if (robin_hood && item->dist < entry->dist) {
+      struct SetItem displaced;
+      _SetItem_move(&displaced, item);
+      _SetItem_move(item, entry);
+      _SetItem_move(entry, &displaced);
+
+      void* displaced_value = _Set_value(s, item);
+      _Set_set_value(s, item, *value);
+      *value = displaced_value;
+    }
+    entry->dist += robin_hood;
+  }
+
+  return 0;
+}
+
+static void
+_Set_build_place(struct _SetBuild* b, size_t part)
+{
+  struct Set* s = b->out;
+  struct Arena* arena = b->arenas != NULL ? b->arenas[part] : NULL;
+  size_t lo = part * b->part_size;
+  size_t hi = lo + b->part_size < s->capacity ? lo + b->part_size : s->capacity;
+
+  for (size_t row = 0; row < b->source_count * b->parts; row++) {
+    const struct Set* owner = _SetSource_owner(&b->sources[row / b->parts]);
+    struct _SetRefs* bucket = &b->buckets[row * b->parts + part];
+
+    for (size_t i = 0; i < bucket->length; i++) {
+      const struct SetItem* item = bucket->refs[i].item;
+      struct SetItem entry = _SetItem_copy_key_to(
+        arena, item->key, item->key_len, bucket->refs[i].hash);
+      void* value = _Set_value(owner, item);
+
+      if (!_Set_place_in_range(s, &entry, &value, lo, hi)) {
+        _SetDeferred_push(&b->deferred[part], &entry, value);
+      }
+    }
+  }
+}
+
+struct _SetPool
+{
+  struct _SetBuild* build;
+  void (*task)(struct _SetBuild*, size_t);
+  size_t tasks;
+  atomic_size_t next;
+};
+
+static void*
+_Set_pool_worker(void* arg)
+{
+  struct _SetPool* pool = arg;
+
+  for (;;) {
+    size_t task = atomic_fetch_add(&pool->next, 1);
+    if (task >= pool->tasks) {
+      return NULL;
+    }
+    pool->task(pool->build, task);
+  }
+}
+
+/*
+ * Runs the tasks on up to workers threads, the calling thread included.
+ * Tasks are handed out one at a time, so threads that could not be started
+ * only slow the run down.
+ */
+static void
+_Set_run_tasks(struct _SetBuild* b,
+               void (*task)(struct _SetBuild*, size_t),
+               size_t tasks,
+               size_t workers)
+{
+  struct _SetPool pool = { .build = b, .task = task, .tasks = tasks };
+  atomic_init(&pool.next, 0);
+
+  if (workers > tasks) {
+    workers = tasks;
+  }
+
+  pthread_t* threads = malloc(workers * sizeof(pthread_t));
+  size_t started = 0;
+  for (size_t t = 1; t < workers; t++) {
+    if (pthread_create(&threads[started], NULL, _Set_pool_worker, &pool) ==
+        0) {
+      started += 1;
+    }
+  }
+
+  _Set_pool_worker(&pool);
+
+  for (size_t t = 0; t < started; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  free(threads);
+}
+
+/*
+ * Builds a set like s sized for load keys from the sources. The table is
+ * split into up to threads parts, and no more threads than online CPUs are
+ * started.
+ */
+static struct Set*
+_Set_build_parallel(struct Set* s,
+                    size_t load,
+                    const struct _SetSource* sources,
+                    size_t source_count,
+                    size_t threads)
+{
+  struct Set* out = _Set_new_like(s, load);
+
+  if (threads == 0) {
+    threads = 1;
+  } else if (threads > SET_PARALLEL_MAX_PARTS) {
+    threads = SET_PARALLEL_MAX_PARTS;
+  }
+
+  struct _SetBuild b = { .out = out,
+                         .sources = sources,
+                         .source_count = source_count };
+  b.part_size = (out->capacity + threads - 1) / threads;
+  if (b.part_size < SET_PARALLEL_MIN_SLOTS) {
+    b.part_size = SET_PARALLEL_MIN_SLOTS;
+  }
+  b.parts = (out->capacity + b.part_size - 1) / b.part_size;
+
+  b.buckets =
+    calloc(source_count * b.parts * b.parts, sizeof(struct _SetRefs));
+  b.deferred = calloc(b.parts, sizeof(struct _SetDeferred));
+  b.arenas = NULL;
+  if (out->arena != NULL) {
+    b.arenas = malloc(b.parts * sizeof(struct Arena*));
+    for (size_t p = 0; p < b.parts; p++) {
+      b.arenas[p] = Arena_new(SET_ARENA_CHUNK_SIZE);
+    }
+  }
+
+  size_t workers = threads;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpus > 0 && workers > (size_t)cpus) {
+    workers = (size_t)cpus;
+  }
+
+  _Set_run_tasks(&b, _Set_build_scan, source_count * b.parts, workers);
+  _Set_run_tasks(&b, _Set_build_place, b.parts, workers);
+
+  for (size_t i = 0; i < source_count * b.parts * b.parts; i++) {
+    out->load += b.buckets[i].length;
+    free(b.buckets[i].refs);
+  }
+
+  for (size_t p = 0; p < b.parts; p++) {
+    if (b.arenas != NULL) {
+      Arena_merge(out->arena, b.arenas[p]);
+    }
+    for (size_t i = 0; i < b.deferred[p].length; i++) {
+      struct SetValueItem* e = &b.deferred[p].entries[i];
+      _Set_place(out, e->item, e->value);
+    }
+    free(b.deferred[p].entries);
+  }
+
+  free(b.buckets);
+  free(b.deferred);
+  free(b.arenas);
+
+  return out;
+}
+
+struct Set*
+Set_intersection_parallel(struct Set* s_a, struct Set* s_b, size_t threads)
+{
+  _Set_migrate(s_a, SIZE_MAX);
+  _Set_migrate(s_b, SIZE_MAX);
+
+  struct Set* small = s_a->load <= s_b->load ? s_a : s_b;
+  struct Set* large = small == s_a ? s_b : s_a;
+
+  // Keep the items of s_a, so values come from s_a as in Set_intersection
+  struct _SetSource source = { .s = small,
+                               .probe = large,
+                               .want_found = 1,
+                               .from_probe = small == s_b };
+
+  return _Set_build_parallel(s_a, small->load, &source, 1, threads);
+}
+
+struct Set*
+Set_union_parallel(struct Set* s_a, struct Set* s_b, size_t threads)
+{
+  _Set_migrate(s_a, SIZE_MAX);
+  _Set_migrate(s_b, SIZE_MAX);
+
+  // Every key of s_a, then the keys of s_b it is missing
+  struct _SetSource sources[] = {
+    { .s = s_a, .probe = NULL, .want_found = 0, .from_probe = 0 },
+    { .s = s_b, .probe = s_a, .want_found = 0, .from_probe = 0 },
+  };
+
+  return _Set_build_parallel(
+    s_a, s_a->load + s_b->load, sources, 2, threads);
+}
+
+struct SetIterator*
+SetIterator_new(struct Set* s)
+{
+  // Iterate a single table, any operation may move entries between tables
+  _Set_migrate(s, SIZE_MAX);
+
   struct SetIterator* iterator = malloc(sizeof(struct SetIterator));
 
   iterator->set = s;
@@ -237,8 +1699,9 @@ SetIterator_next(struct SetIterator* iterator)
 
   for (size_t i = iterator->idx; i < iterator->set->capacity; i++) {
     iterator->idx += 1;
-    if (iterator->set->table[i].key != NULL) {
-      return &iterator->set->table[i];
+    struct SetItem* item = _Set_item(iterator->set, i);
+    if (item->key != NULL) {
+      return item;
     }
   }
 
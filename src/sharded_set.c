@@ -0,0 +1,112 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sharded_set.h"
+#include "hash.h"
+#include "segmented_set.h"
+#include "set.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct ShardedSet*
+ShardedSet_new(size_t inital_capacity, size_t shard_count)
+{
+  return ShardedSet_new_with_options(
+    inital_capacity, shard_count, 0, wyhash, 0);
+}
+
+struct ShardedSet*
+ShardedSet_new_with_options(size_t inital_capacity,
+                            size_t shard_count,
+                            unsigned int flags,
+                            HashFunction hash,
+                            uint64_t seed)
+{
+  struct ShardedSet* s = malloc(sizeof(struct ShardedSet));
+
+  SegmentedSet_init(&s->base, inital_capacity, shard_count, flags, hash, seed);
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    pthread_mutex_init(&s->base.segments[i].lock.mutex, NULL);
+  }
+
+  return s;
+}
+
+void
+ShardedSet_free(struct ShardedSet* s)
+{
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    pthread_mutex_destroy(&s->base.segments[i].lock.mutex);
+  }
+
+  SegmentedSet_destroy(&s->base);
+  free(s);
+}
+
+int
+ShardedSet_has(struct ShardedSet* s, char* key, size_t key_len)
+{
+  uint64_t hash = s->base.hash(key, key_len, s->base.seed);
+  struct SegmentedSetSegment* shard = SegmentedSet_segment(&s->base, hash);
+
+  pthread_mutex_lock(&shard->lock.mutex);
+  int res = Set_has_hashed(shard->set, key, key_len, hash);
+  pthread_mutex_unlock(&shard->lock.mutex);
+
+  return res;
+}
+
+int
+ShardedSet_put(struct ShardedSet* s, char* key, size_t key_len)
+{
+  uint64_t hash = s->base.hash(key, key_len, s->base.seed);
+  struct SegmentedSetSegment* shard = SegmentedSet_segment(&s->base, hash);
+
+  int inserted;
+  pthread_mutex_lock(&shard->lock.mutex);
+  Set_insert_or_find_hashed(shard->set, key, key_len, hash, &inserted);
+  pthread_mutex_unlock(&shard->lock.mutex);
+
+  return inserted;
+}
+
+void
+ShardedSet_delete(struct ShardedSet* s, char* key, size_t key_len)
+{
+  uint64_t hash = s->base.hash(key, key_len, s->base.seed);
+  struct SegmentedSetSegment* shard = SegmentedSet_segment(&s->base, hash);
+
+  pthread_mutex_lock(&shard->lock.mutex);
+  Set_delete_hashed(shard->set, key, key_len, hash);
+  pthread_mutex_unlock(&shard->lock.mutex);
+}
+
+size_t
+ShardedSet_load(struct ShardedSet* s)
+{
+  size_t load = 0;
+
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    struct SegmentedSetSegment* shard = &s->base.segments[i];
+    pthread_mutex_lock(&shard->lock.mutex);
+    load += shard->set->load;
+    pthread_mutex_unlock(&shard->lock.mutex);
+  }
+
+  return load;
+}
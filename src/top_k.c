@@ -0,0 +1,160 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "top_k.h"
+#include "count_min_sketch.h"
+#include "map.h"
+#include "sort.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct TopK*
+TopK_new(size_t k, double epsilon, double delta)
+{
+  struct TopK* t = malloc(sizeof(struct TopK));
+
+  t->sketch = CountMinSketch_new(epsilon, delta);
+  t->items = Map_new(k * 2 + 1);
+  t->heap = malloc(k * sizeof(struct TopKItem*));
+  t->len = 0;
+  t->k = k;
+
+  return t;
+}
+
+void
+TopK_free(struct TopK* t)
+{
+  for (size_t i = 0; i < t->len; i++) {
+    free(t->heap[i]);
+  }
+  free(t->heap);
+  Map_free(t->items);
+  CountMinSketch_free(t->sketch);
+  free(t);
+}
+
+static inline void
+_TopK_place(struct TopK* t, struct TopKItem* item, size_t index)
+{
+  t->heap[index] = item;
+  item->index = index;
+}
+
+static void
+_TopK_sift_up(struct TopK* t, size_t index)
+{
+  struct TopKItem* item = t->heap[index];
+
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (t->heap[parent]->count <= item->count) {
+      break;
+    }
+    _TopK_place(t, t->heap[parent], index);
+    index = parent;
+  }
+  _TopK_place(t, item, index);
+}
+
+static void
+_TopK_sift_down(struct TopK* t, size_t index)
+{
+  struct TopKItem* item = t->heap[index];
+
+  while (index * 2 + 1 < t->len) {
+    size_t child = index * 2 + 1;
+    if (child + 1 < t->len &&
+        t->heap[child + 1]->count < t->heap[child]->count) {
+      child += 1;
+    }
+    if (item->count <= t->heap[child]->count) {
+      break;
+    }
+    _TopK_place(t, t->heap[child], index);
+    index = child;
+  }
+  _TopK_place(t, item, index);
+}
+
+/*
+ * Adds the item to the Map under the key and points it at the Map's copy.
+ */
+static void
+_TopK_track(struct TopK* t, struct TopKItem* item, char* key, size_t key_len)
+{
+  struct SetItem* stored = Map_put(t->items, key, key_len, item);
+
+  item->key = stored->key;
+  item->key_len = key_len;
+  if (key_len <= SET_INLINE_KEY_LEN) {
+    memcpy(item->inline_key, key, key_len);
+    item->key = item->inline_key;
+  }
+}
+
+uint32_t
+TopK_add(struct TopK* t, char* key, size_t key_len, uint32_t count)
+{
+  uint32_t estimate = CountMinSketch_add(t->sketch, key, key_len, count);
+  if (t->k == 0) {
+    return estimate;
+  }
+
+  struct TopKItem* item = Map_get(t->items, key, key_len);
+  if (item != NULL) {
+    // Counts only grow, so a tracked item can only move away from the root
+    item->count = estimate;
+    _TopK_sift_down(t, item->index);
+    return estimate;
+  }
+
+  if (t->len < t->k) {
+    item = malloc(sizeof(struct TopKItem));
+    item->count = estimate;
+    t->heap[t->len] = item;
+    t->len += 1;
+    _TopK_sift_up(t, t->len - 1);
+  } else if (estimate > t->heap[0]->count) {
+    item = t->heap[0];
+    Map_delete(t->items, item->key, item->key_len);
+    item->count = estimate;
+    _TopK_sift_down(t, 0);
+  } else {
+    return estimate;
+  }
+
+  _TopK_track(t, item, key, key_len);
+
+  return estimate;
+}
+
+static int
+_TopK_cmp(void* a, void* b)
+{
+  return ((struct TopKItem*)a)->count < ((struct TopKItem*)b)->count;
+}
+
+size_t
+TopK_list(struct TopK* t, struct TopKItem** out)
+{
+  memcpy(out, t->heap, t->len * sizeof(struct TopKItem*));
+  Sort_mergesort((void**)out, t->len, _TopK_cmp);
+
+  return t->len;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "u64_set.h"
+#include "constants.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define U64_SET_MAX_LOAD 0.75f
+
+static void
+_U64Set_alloc_table(struct U64Set* s, size_t capacity)
+{
+  s->table = calloc(capacity, sizeof(uint64_t));
+  s->capacity = capacity;
+
+  s->shift = 64;
+  for (size_t c = capacity; c > 1; c >>= 1) {
+    s->shift -= 1;
+  }
+}
+
+struct U64Set*
+U64Set_new(size_t inital_capacity)
+{
+  struct U64Set* s = malloc(sizeof(struct U64Set));
+
+  size_t capacity = 2;
+  while (capacity < inital_capacity) {
+    capacity *= 2;
+  }
+
+  _U64Set_alloc_table(s, capacity);
+  s->load = 0;
+  s->has_zero = 0;
+
+  return s;
+}
+
+void
+U64Set_free(struct U64Set* s)
+{
+  free(s->table);
+  free(s);
+}
+
+static inline size_t
+_U64Set_home(const struct U64Set* s, uint64_t key)
+{
+  return (size_t)((key * FIBONACCI_MULTIPLIER) >> s->shift);
+}
+
+/*
+ * Returns the slot holding the key, or the empty slot that ends its probe
+ * sequence. The key must not be 0.
+ */
+static inline size_t
+_U64Set_find(const struct U64Set* s, uint64_t key)
+{
+  size_t mask = s->capacity - 1;
+  size_t idx = _U64Set_home(s, key);
+
+  while (s->table[idx] != key && s->table[idx] != 0) {
+    idx = (idx + 1) & mask;
+  }
+
+  return idx;
+}
+
+static void
+_U64Set_expand(struct U64Set* s)
+{
+  uint64_t* old_table = s->table;
+  size_t old_capacity = s->capacity;
+
+  _U64Set_alloc_table(s, old_capacity * 2);
+
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old_table[i] != 0) {
+      s->table[_U64Set_find(s, old_table[i])] = old_table[i];
+    }
+  }
+
+  free(old_table);
+}
+
+int
+U64Set_has(struct U64Set* s, uint64_t key)
+{
+  if (key == 0) {
+    return s->has_zero;
+  }
+
+  return s->table[_U64Set_find(s, key)] != 0;
+}
+
+int
+U64Set_put(struct U64Set* s, uint64_t key)
+{
+  if (key == 0) {
+    int added = !s->has_zero;
+    s->has_zero = 1;
+    s->load += (size_t)added;
+    return added;
+  }
+
+  if ((float)(s->load + 1) / s->capacity > U64_SET_MAX_LOAD) {
+    _U64Set_expand(s);
+  }
+
+  size_t idx = _U64Set_find(s, key);
+  if (s->table[idx] != 0) {
+    return 0;
+  }
+
+  s->table[idx] = key;
+  s->load += 1;
+
+  return 1;
+}
+
+void
+U64Set_delete(struct U64Set* s, uint64_t key)
+{
+  if (key == 0) {
+    s->load -= (size_t)s->has_zero;
+    s->has_zero = 0;
+    return;
+  }
+
+  size_t mask = s->capacity - 1;
+  size_t hole = _U64Set_find(s, key);
+  if (s->table[hole] == 0) {
+    return;
+  }
+
+  s->table[hole] = 0;
+  s->load -= 1;
+
+  // Backward shift, moving each following key into the hole unless its
+  // home lies between the hole and its slot
+  for (size_t idx = (hole + 1) & mask; s->table[idx] != 0;
+       idx = (idx + 1) & mask) {
+    size_t dist = (idx - _U64Set_home(s, s->table[idx])) & mask;
+    if (dist >= ((idx - hole) & mask)) {
+      s->table[hole] = s->table[idx];
+      s->table[idx] = 0;
+      hole = idx;
+    }
+  }
+}
+
+struct U64SetIterator*
+U64SetIterator_new(struct U64Set* s)
+{
+  struct U64SetIterator* iterator = malloc(sizeof(struct U64SetIterator));
+
+  iterator->set = s;
+  iterator->idx = 0;
+  iterator->zero_done = 0;
+
+  return iterator;
+}
+
+void
+U64SetIterator_free(struct U64SetIterator* iterator)
+{
+  free(iterator);
+}
+
+int
+U64SetIterator_next(struct U64SetIterator* iterator, uint64_t* key)
+{
+  if (!iterator->zero_done) {
+    iterator->zero_done = 1;
+    if (iterator->set->has_zero) {
+      *key = 0;
+      return 1;
+    }
+  }
+
+  while (iterator->idx < iterator->set->capacity) {
+    uint64_t slot = iterator->set->table[iterator->idx];
+    iterator->idx += 1;
+    if (slot != 0) {
+      *key = slot;
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "arena.h"
+#include "munit.h"
+#include <string.h>
+
+static MunitResult
+test_Arena_new()
+{
+  struct Arena* a = Arena_new(64);
+
+  munit_assert_ptr_null(a->chunk);
+  munit_assert_size(a->chunk_size, ==, 64);
+
+  Arena_free(a);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Arena_alloc()
+{
+  // Setup
+  struct Arena* a = Arena_new(64);
+
+  // Test allocations are packed into one chunk
+  char* data_1 = Arena_alloc(a, 10);
+  memcpy(data_1, "0123456789", 10);
+
+  munit_assert_ptr_not_null(a->chunk);
+  munit_assert_size(a->chunk->capacity, ==, 64);
+  munit_assert_size(a->chunk->length, ==, 10);
+
+  char* data_2 = Arena_alloc(a, 20);
+  memcpy(data_2, "abcdefghijklmnopqrst", 20);
+
+  munit_assert_ptr(data_2, ==, data_1 + 10);
+  munit_assert_size(a->chunk->length, ==, 30);
+
+  // Test a full chunk starts a new one
+  char* data_3 = Arena_alloc(a, 30);
+
+  munit_assert_ptr(data_3, ==, data_1 + 30);
+  munit_assert_size(a->chunk->length, ==, 60);
+
+  char* data_4 = Arena_alloc(a, 10);
+
+  munit_assert_ptr(a->chunk->data, ==, data_4);
+  munit_assert_size(a->chunk->length, ==, 10);
+  munit_assert_ptr_not_null(a->chunk->next);
+  munit_assert_ptr(a->chunk->next->data, ==, data_1);
+
+  // Test oversized allocations do not retire the current chunk
+  char* data_5 = Arena_alloc(a, 100);
+  memset(data_5, 'x', 100);
+
+  munit_assert_ptr(a->chunk->data, ==, data_4);
+  munit_assert_ptr(a->chunk->next->data, ==, data_5);
+  munit_assert_size(a->chunk->next->capacity, ==, 100);
+
+  char* data_6 = Arena_alloc(a, 10);
+
+  munit_assert_ptr(data_6, ==, data_4 + 10);
+
+  munit_assert_memory_equal(10, data_1, "0123456789");
+  munit_assert_memory_equal(20, data_2, "abcdefghijklmnopqrst");
+
+  // Teardown
+  Arena_free(a);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Arena_merge()
+{
+  // Setup
+  struct Arena* a = Arena_new(64);
+  struct Arena* b = Arena_new(64);
+
+  char* data_1 = Arena_alloc(a, 10);
+  memcpy(data_1, "0123456789", 10);
+  char* data_2 = Arena_alloc(b, 10);
+  memcpy(data_2, "abcdefghij", 10);
+
+  // Test merged chunks follow the current chunk
+  Arena_merge(a, b);
+
+  munit_assert_ptr(a->chunk->data, ==, data_1);
+  munit_assert_ptr(a->chunk->next->data, ==, data_2);
+  munit_assert_memory_equal(10, data_2, "abcdefghij");
+
+  // Test the current chunk is still filled first
+  char* data_3 = Arena_alloc(a, 10);
+
+  munit_assert_ptr(data_3, ==, data_1 + 10);
+
+  // Teardown
+  Arena_free(a);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_Arena_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/alloc", test_Arena_alloc, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/merge", test_Arena_merge, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/Arena", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "bloom_filter.h"
+#include "munit.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static MunitResult
+test_BloomFilter_new()
+{
+  // Test new sizes the filter from the key count and false positive rate,
+  // 10000 keys at 1% need 95851 bits and 7 hashes unblocked, blocking adds
+  // about 5% to keep the same rate
+  struct BloomFilter* f = BloomFilter_new(10000, 0.01);
+
+  munit_assert_size(f->block_count, ==, 197);
+  munit_assert_uint(f->hashes, ==, 7);
+  munit_assert_uint64((uintptr_t)f->blocks % 64, ==, 0);
+
+  for (size_t i = 0; i < f->block_count * BLOOM_FILTER_BLOCK_WORDS; i++) {
+    munit_assert_uint64(f->blocks[i], ==, 0);
+  }
+
+  // Teardown
+  BloomFilter_free(f);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_BloomFilter_add()
+{
+  // Setup
+  struct BloomFilter* f = BloomFilter_new(10000, 0.01);
+  char key[16];
+
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    BloomFilter_add(f, key, key_len);
+  }
+
+  // Test there are no false negatives
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(BloomFilter_maybe_has(f, key, key_len), ==, 1);
+  }
+
+  // Test false positives stay close to the requested rate
+  int false_positives = 0;
+  for (int i = 0; i < 100000; i++) {
+    int key_len = snprintf(key, sizeof(key), "miss-%d", i);
+    false_positives += BloomFilter_maybe_has(f, key, key_len);
+  }
+
+  munit_assert_int(false_positives, <, 2000);
+
+  // Test a seeded filter keeps its keys in different bits
+  struct BloomFilter* seeded = BloomFilter_new_with_seed(10000, 0.01, 42);
+
+  munit_assert_uint64(seeded->seed, ==, 42);
+  munit_assert_size(seeded->block_count, ==, f->block_count);
+
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    BloomFilter_add(seeded, key, key_len);
+  }
+
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(BloomFilter_maybe_has(seeded, key, key_len), ==, 1);
+  }
+
+  size_t differing_words = 0;
+  for (size_t i = 0; i < f->block_count * BLOOM_FILTER_BLOCK_WORDS; i++) {
+    differing_words += f->blocks[i] != seeded->blocks[i];
+  }
+
+  munit_assert_size(differing_words, >, 0);
+
+  // Teardown
+  BloomFilter_free(f);
+  BloomFilter_free(seeded);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_BloomFilter_add_low_rate()
+{
+  // Setup
+  struct BloomFilter* f = BloomFilter_new(100000, 0.001);
+  char key[16];
+
+  for (int i = 0; i < 100000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    BloomFilter_add(f, key, key_len);
+  }
+
+  // Test false positives stay close to a rate well under 1%
+  int false_positives = 0;
+  for (int i = 0; i < 1000000; i++) {
+    int key_len = snprintf(key, sizeof(key), "miss-%d", i);
+    false_positives += BloomFilter_maybe_has(f, key, key_len);
+  }
+
+  munit_assert_int(false_positives, <, 1250);
+
+  // Teardown
+  BloomFilter_free(f);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_BloomFilter_union()
+{
+  // Setup
+  struct BloomFilter* f_a = BloomFilter_new_with_seed(100, 0.01, 7);
+  struct BloomFilter* f_b = BloomFilter_new_with_seed(100, 0.01, 7);
+
+  BloomFilter_add(f_a, "apple", 5);
+  BloomFilter_add(f_b, "banana", 6);
+
+  // Test the union holds the keys of both
+  struct BloomFilter* f = BloomFilter_union(f_a, f_b);
+
+  munit_assert_uint64(f->seed, ==, 7);
+  munit_assert_int(BloomFilter_maybe_has(f, "apple", 5), ==, 1);
+  munit_assert_int(BloomFilter_maybe_has(f, "banana", 6), ==, 1);
+  munit_assert_int(BloomFilter_maybe_has(f_a, "banana", 6), ==, 0);
+
+  // Teardown
+  BloomFilter_free(f_a);
+  BloomFilter_free(f_b);
+  BloomFilter_free(f);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_BloomFilter_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/add", test_BloomFilter_add, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/add_low_rate", test_BloomFilter_add_low_rate, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/union", test_BloomFilter_union, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/BloomFilter", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
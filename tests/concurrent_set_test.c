@@ -0,0 +1,161 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "concurrent_set.h"
+#include "munit.h"
+#include "set.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+
+static MunitResult
+test_ConcurrentSet_new()
+{
+  // Test new rounds the segment count up to a power of two
+  struct ConcurrentSet* s = ConcurrentSet_new(1024, 6);
+
+  munit_assert_size(s->base.segment_count, ==, 8);
+  munit_assert_uint(s->base.segment_bits, ==, 3);
+  munit_assert_size(ConcurrentSet_load(s), ==, 0);
+
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    munit_assert_size(s->base.segments[i].set->capacity, ==, 128);
+  }
+
+  // Teardown
+  ConcurrentSet_free(s);
+
+  // Test SET_INCREMENTAL_RESIZE is dropped from the segments' options
+  s = ConcurrentSet_new_with_options(
+    16, 2, SET_SWISS_TABLE | SET_INCREMENTAL_RESIZE, wyhash, 0);
+
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    unsigned int flags = s->base.segments[i].set->flags;
+    munit_assert_uint(flags & SET_INCREMENTAL_RESIZE, ==, 0);
+    munit_assert_uint(flags & SET_SWISS_TABLE, ==, SET_SWISS_TABLE);
+  }
+
+  // Teardown
+  ConcurrentSet_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_ConcurrentSet_put()
+{
+  // Setup
+  struct ConcurrentSet* s =
+    ConcurrentSet_new_with_options(16, 4, SET_SWISS_TABLE, wyhash, 0);
+  char key[16];
+
+  // Test put, has and delete on one thread
+  for (int i = 0; i < 200; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(ConcurrentSet_put(s, key, key_len), ==, 1);
+  }
+
+  munit_assert_int(ConcurrentSet_put(s, "key-7", 5), ==, 0);
+  munit_assert_size(ConcurrentSet_load(s), ==, 200);
+
+  for (int i = 0; i < 200; i += 2) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    ConcurrentSet_delete(s, key, key_len);
+  }
+
+  for (int i = 0; i < 200; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(ConcurrentSet_has(s, key, key_len), ==, i % 2);
+  }
+
+  // Test keys are spread over every segment
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    munit_assert_size(s->base.segments[i].set->load, >, 0);
+  }
+
+  // Teardown
+  ConcurrentSet_free(s);
+
+  return MUNIT_OK;
+}
+
+struct worker
+{
+  struct ConcurrentSet* s;
+  int start;
+  int found;
+};
+
+static void*
+worker_run(void* arg)
+{
+  struct worker* w = arg;
+  char key[16];
+
+  // Writes overlap with the next worker's range, reads run against both
+  for (int i = w->start; i < w->start + 2000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    ConcurrentSet_put(w->s, key, key_len);
+    w->found += ConcurrentSet_has(w->s, key, key_len);
+  }
+
+  return NULL;
+}
+
+static MunitResult
+test_ConcurrentSet_threads()
+{
+  // Setup
+  struct ConcurrentSet* s = ConcurrentSet_new(16, 8);
+  struct worker workers[4];
+  pthread_t threads[4];
+
+  // Test concurrent writers and readers see every key exactly once
+  for (int i = 0; i < 4; i++) {
+    workers[i] = (struct worker){ .s = s, .start = i * 1000, .found = 0 };
+    pthread_create(&threads[i], NULL, worker_run, &workers[i]);
+  }
+  for (int i = 0; i < 4; i++) {
+    pthread_join(threads[i], NULL);
+    munit_assert_int(workers[i].found, ==, 2000);
+  }
+
+  munit_assert_size(ConcurrentSet_load(s), ==, 5000);
+
+  // Teardown
+  ConcurrentSet_free(s);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_ConcurrentSet_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/put", test_ConcurrentSet_put, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/threads", test_ConcurrentSet_threads, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/ConcurrentSet", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "count_min_sketch.h"
+#include "munit.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static MunitResult
+test_CountMinSketch_new()
+{
+  // Test new sizes the sketch from the error bounds, e / 0.001 rounds up to
+  // 4096 counters per row and ln(1 / 0.01) up to 5 rows
+  struct CountMinSketch* cms = CountMinSketch_new(0.001, 0.01);
+
+  munit_assert_size(cms->width, ==, 4096);
+  munit_assert_uint(cms->depth, ==, 5);
+  munit_assert_uint64(cms->total, ==, 0);
+
+  for (size_t i = 0; i < cms->width * cms->depth; i++) {
+    munit_assert_uint32(cms->counters[i], ==, 0);
+  }
+
+  // Teardown
+  CountMinSketch_free(cms);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_CountMinSketch_add()
+{
+  // Setup, key i is added 1000 / (i + 1) times
+  struct CountMinSketch* cms = CountMinSketch_new(0.001, 0.01);
+  char key[16];
+
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    uint32_t estimate = CountMinSketch_add(cms, key, key_len, 1000 / (i + 1));
+    munit_assert_uint32(
+      estimate, ==, CountMinSketch_estimate(cms, key, key_len));
+  }
+
+  // Test estimates never undercount, and stay within epsilon * total for
+  // all but a delta fraction of keys
+  uint32_t bound = (uint32_t)(cms->total / 1000);
+  int over_bound = 0;
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    uint32_t estimate = CountMinSketch_estimate(cms, key, key_len);
+    munit_assert_uint32(estimate, >=, 1000 / (i + 1));
+    over_bound += estimate > 1000 / (i + 1) + bound;
+  }
+
+  munit_assert_int(over_bound, <, 100);
+
+  // Test heavy keys are exact in a sketch this wide
+  munit_assert_uint32(CountMinSketch_estimate(cms, "key-0", 5), ==, 1000);
+  munit_assert_uint32(CountMinSketch_estimate(cms, "key-1", 5), ==, 500);
+
+  // Teardown
+  CountMinSketch_free(cms);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_CountMinSketch_saturate()
+{
+  // Setup
+  struct CountMinSketch* cms = CountMinSketch_new_with_size(16, 2, 0);
+
+  // Test counters stop at UINT32_MAX instead of wrapping
+  CountMinSketch_add(cms, "key", 3, UINT32_MAX - 1);
+  munit_assert_uint32(CountMinSketch_add(cms, "key", 3, 5), ==, UINT32_MAX);
+  munit_assert_uint32(CountMinSketch_estimate(cms, "key", 3), ==, UINT32_MAX);
+
+  // Teardown
+  CountMinSketch_free(cms);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_CountMinSketch_merge()
+{
+  // Setup
+  struct CountMinSketch* cms_a = CountMinSketch_new(0.001, 0.01);
+  struct CountMinSketch* cms_b = CountMinSketch_new(0.001, 0.01);
+  char key[16];
+
+  for (int i = 0; i < 1000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    CountMinSketch_add(cms_a, key, key_len, 2);
+    CountMinSketch_add(cms_b, key, key_len, 3);
+  }
+
+  // Test merged counts are the sum of both streams
+  CountMinSketch_merge(cms_a, cms_b);
+
+  munit_assert_uint64(cms_a->total, ==, 5000);
+  for (int i = 0; i < 1000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_uint32(CountMinSketch_estimate(cms_a, key, key_len), >=, 5);
+  }
+  munit_assert_uint32(CountMinSketch_estimate(cms_a, "key-0", 5), <=, 10);
+
+  // Teardown
+  CountMinSketch_free(cms_a);
+  CountMinSketch_free(cms_b);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_CountMinSketch_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/add", test_CountMinSketch_add, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/saturate", test_CountMinSketch_saturate, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/merge", test_CountMinSketch_merge, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/CountMinSketch", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
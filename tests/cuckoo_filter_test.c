@@ -0,0 +1,202 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "cuckoo_filter.h"
+#include "munit.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static MunitResult
+test_CuckooFilter_new()
+{
+  // Test new rounds up to a power of two number of buckets
+  struct CuckooFilter* f = CuckooFilter_new(1000);
+
+  munit_assert_size(f->bucket_count, ==, 512);
+  munit_assert_size(f->load, ==, 0);
+
+  // Teardown
+  CuckooFilter_free(f);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_CuckooFilter_add()
+{
+  // Setup
+  struct CuckooFilter* f = CuckooFilter_new(10000);
+  char key[16];
+
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(CuckooFilter_add(f, key, key_len), ==, 1);
+  }
+
+  munit_assert_size(f->load, ==, 10000);
+
+  // Test there are no false negatives
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(CuckooFilter_has(f, key, key_len), ==, 1);
+  }
+
+  // Test false positives stay near 8 / 2^16
+  int false_positives = 0;
+  for (int i = 0; i < 100000; i++) {
+    int key_len = snprintf(key, sizeof(key), "miss-%d", i);
+    false_positives += CuckooFilter_has(f, key, key_len);
+  }
+
+  munit_assert_int(false_positives, <, 50);
+
+  // Test a seeded filter keeps its keys in different slots
+  struct CuckooFilter* seeded = CuckooFilter_new_with_seed(10000, 42);
+
+  munit_assert_uint64(seeded->seed, ==, 42);
+  munit_assert_size(seeded->bucket_count, ==, f->bucket_count);
+
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(CuckooFilter_add(seeded, key, key_len), ==, 1);
+  }
+
+  for (int i = 0; i < 10000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(CuckooFilter_has(seeded, key, key_len), ==, 1);
+  }
+
+  size_t differing_slots = 0;
+  for (size_t i = 0; i < f->bucket_count * CUCKOO_FILTER_BUCKET_SIZE; i++) {
+    differing_slots += f->buckets[i] != seeded->buckets[i];
+  }
+
+  munit_assert_size(differing_slots, >, 0);
+
+  // Teardown
+  CuckooFilter_free(f);
+  CuckooFilter_free(seeded);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_CuckooFilter_delete()
+{
+  // Setup
+  struct CuckooFilter* f = CuckooFilter_new(1000);
+  char key[16];
+
+  for (int i = 0; i < 1000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    CuckooFilter_add(f, key, key_len);
+  }
+
+  // Test delete removes keys and leaves the rest
+  for (int i = 0; i < 1000; i += 2) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    CuckooFilter_delete(f, key, key_len);
+  }
+
+  munit_assert_size(f->load, ==, 500);
+
+  int still_found = 0;
+  for (int i = 0; i < 1000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    if (i % 2) {
+      munit_assert_int(CuckooFilter_has(f, key, key_len), ==, 1);
+    } else {
+      still_found += CuckooFilter_has(f, key, key_len);
+    }
+  }
+
+  munit_assert_int(still_found, <, 5);
+
+  // Test a key added twice needs two deletes
+  CuckooFilter_add(f, "twice", 5);
+  CuckooFilter_add(f, "twice", 5);
+  CuckooFilter_delete(f, "twice", 5);
+  munit_assert_int(CuckooFilter_has(f, "twice", 5), ==, 1);
+  CuckooFilter_delete(f, "twice", 5);
+  munit_assert_int(CuckooFilter_has(f, "twice", 5), ==, 0);
+
+  // Teardown
+  CuckooFilter_free(f);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_CuckooFilter_full()
+{
+  // Setup, 64 slots
+  struct CuckooFilter* f = CuckooFilter_new(60);
+  char key[16];
+
+  // Test adds fail once full without losing any stored key
+  int added = 0;
+  while (1) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", added);
+    if (!CuckooFilter_add(f, key, key_len)) {
+      break;
+    }
+    added += 1;
+  }
+
+  munit_assert_int(added, >, 48);
+  munit_assert_uint(f->victim, !=, 0);
+
+  for (int i = 0; i <= added; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(CuckooFilter_has(f, key, key_len), ==, 1);
+  }
+
+  // Test a delete makes room for the held back fingerprint
+  CuckooFilter_delete(f, "key-0", 5);
+
+  munit_assert_uint(f->victim, ==, 0);
+  munit_assert_size(f->load, ==, (size_t)added);
+  for (int i = 1; i <= added; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(CuckooFilter_has(f, key, key_len), ==, 1);
+  }
+
+  // Teardown
+  CuckooFilter_free(f);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_CuckooFilter_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/add", test_CuckooFilter_add, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/delete", test_CuckooFilter_delete, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/full", test_CuckooFilter_full, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/CuckooFilter", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -18,6 +18,7 @@
 
 #include "hash.h"
 #include "munit.h"
+#include <stdio.h>
 #include <string.h>
 
 static MunitResult
@@ -59,9 +60,231 @@ test_fnv_1a_hash()
   return MUNIT_OK;
 }
 
+static MunitResult
+test_fnv_1a_hash_seeded()
+{
+  char* data_1 = "test";
+
+  // A zero seed matches the unseeded hash
+  uint64_t res_1 = fnv_1a_hash_seeded(data_1, strlen(data_1), 0);
+
+  munit_assert_uint64(res_1, ==, fnv_1a_hash(data_1, strlen(data_1)));
+
+  uint64_t res_2 = fnv_1a_hash_seeded(data_1, strlen(data_1), 1);
+
+  munit_assert_uint64(res_2, !=, res_1);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_wyhash()
+{
+  // Reference test vectors, seeded with their index
+  char* data_1 = "";
+
+  uint64_t res_1 = wyhash(data_1, strlen(data_1), 0);
+
+  munit_assert_uint64(res_1, ==, 0x93228a4de0eec5a2u);
+
+  char* data_2 = "a";
+
+  uint64_t res_2 = wyhash(data_2, strlen(data_2), 1);
+
+  munit_assert_uint64(res_2, ==, 0xc5bac3db178713c4u);
+
+  char* data_3 = "abc";
+
+  uint64_t res_3 = wyhash(data_3, strlen(data_3), 2);
+
+  munit_assert_uint64(res_3, ==, 0xa97f2f7b1d9b3314u);
+
+  char* data_4 = "message digest";
+
+  uint64_t res_4 = wyhash(data_4, strlen(data_4), 3);
+
+  munit_assert_uint64(res_4, ==, 0x786d1f1df3801df4u);
+
+  char* data_5 = "abcdefghijklmnopqrstuvwxyz";
+
+  uint64_t res_5 = wyhash(data_5, strlen(data_5), 4);
+
+  munit_assert_uint64(res_5, ==, 0xdca5a8138ad37c87u);
+
+  char* data_6 =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+  uint64_t res_6 = wyhash(data_6, strlen(data_6), 5);
+
+  munit_assert_uint64(res_6, ==, 0xb9e734f117cfaf70u);
+
+  char* data_7 = "1234567890123456789012345678901234567890"
+                 "1234567890123456789012345678901234567890";
+
+  uint64_t res_7 = wyhash(data_7, strlen(data_7), 6);
+
+  munit_assert_uint64(res_7, ==, 0x6cc5eab49a92d617u);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_crc32c()
+{
+  // Reference check value and RFC 3720 test vectors
+  char* data_1 = "123456789";
+
+  munit_assert_uint32(crc32c(data_1, strlen(data_1), 0), ==, 0xe3069283u);
+
+  char data_2[32];
+
+  memset(data_2, 0, sizeof(data_2));
+  munit_assert_uint32(crc32c(data_2, 32, 0), ==, 0x8a9136aau);
+
+  memset(data_2, 0xff, sizeof(data_2));
+  munit_assert_uint32(crc32c(data_2, 32, 0), ==, 0x62a8ab43u);
+
+  for (int i = 0; i < 32; i++) {
+    data_2[i] = (char)i;
+  }
+  munit_assert_uint32(crc32c(data_2, 32, 0), ==, 0x46dd794eu);
+
+  // Test continuing from an earlier crc matches one pass
+  uint32_t res_1 = crc32c(data_2 + 13, 19, crc32c(data_2, 13, 0));
+
+  munit_assert_uint32(res_1, ==, 0x46dd794eu);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_crc32c_hash()
+{
+  char* data_1 = "test";
+
+  // Test the seed and length both change the hash
+  uint64_t res_1 = crc32c_hash(data_1, strlen(data_1), 0);
+
+  munit_assert_uint64(res_1, !=, crc32c_hash(data_1, strlen(data_1), 1));
+  munit_assert_uint64(res_1, !=, crc32c_hash("test\0", 5, 0));
+
+  // Test the 32 bit CRC reaches the high bits
+  uint64_t high_bits = 0;
+  char key[16];
+  for (int i = 0; i < 1000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    high_bits |= crc32c_hash(key, key_len, 0) >> 32;
+  }
+
+  munit_assert_uint64(high_bits, ==, 0xffffffffu);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_hash_many()
+{
+  static const HashFunction hashes[] = { fnv_1a_hash_seeded,
+                                         wyhash,
+                                         crc32c_hash };
+  char data[64 * 67];
+  char* keys[67];
+  size_t key_lens[67];
+  uint64_t out[67];
+
+  // Uneven lengths, and bytes over 0x7f to catch sign extension mistakes
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (char)(i * 131 + 7);
+  }
+  for (size_t i = 0; i < 67; i++) {
+    keys[i] = data + i * 64;
+    key_lens[i] = 1 + (i * 37) % 64;
+  }
+
+  // Test every count, including ones that leave a partial group, matches
+  // hashing each key on its own
+  for (size_t h = 0; h < 3; h++) {
+    for (size_t n = 0; n <= 67; n++) {
+      hash_many(hashes[h], 3, keys, key_lens, n, out);
+
+      for (size_t i = 0; i < n; i++) {
+        munit_assert_uint64(out[i], ==, hashes[h](keys[i], key_lens[i], 3));
+      }
+    }
+  }
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Hash_update()
+{
+  static const HashFunction hashes[] = { fnv_1a_hash_seeded,
+                                         wyhash,
+                                         crc32c_hash };
+  char data[200];
+
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (char)(i * 131 + 7);
+  }
+
+  // Test every length split at every point, and fed one byte at a time,
+  // matches the one-shot hash
+  for (size_t h = 0; h < 3; h++) {
+    for (size_t len = 0; len <= sizeof(data); len++) {
+      uint64_t expected = hashes[h](data, len, len);
+
+      for (size_t split = 0; split <= len; split++) {
+        struct HashState state;
+        Hash_init(&state, hashes[h], len);
+        Hash_update(&state, data, split);
+        Hash_update(&state, data + split, len - split);
+
+        munit_assert_uint64(Hash_final(&state), ==, expected);
+      }
+
+      struct HashState state;
+      Hash_init(&state, hashes[h], len);
+      for (size_t i = 0; i < len; i++) {
+        Hash_update(&state, data + i, 1);
+      }
+
+      munit_assert_uint64(Hash_final(&state), ==, expected);
+    }
+  }
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Hash_final()
+{
+  char* data = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+  // Test final leaves the state usable for more data
+  struct HashState state;
+  Hash_init(&state, wyhash, 5);
+  Hash_update(&state, data, 20);
+
+  munit_assert_uint64(Hash_final(&state), ==, wyhash(data, 20, 5));
+
+  Hash_update(&state, data + 20, strlen(data) - 20);
+
+  munit_assert_uint64(Hash_final(&state), ==, 0xb9e734f117cfaf70u);
+
+  return MUNIT_OK;
+}
+
 // clang-format off
 static MunitTest test_suite_tests[] = {
   {"/fnv_1a", test_fnv_1a_hash, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/fnv_1a_seeded", test_fnv_1a_hash_seeded, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/wyhash", test_wyhash, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/crc32c", test_crc32c, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/crc32c_hash", test_crc32c_hash, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/hash_many", test_hash_many, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/Hash_update", test_Hash_update, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/Hash_final", test_Hash_final, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
   {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
 };
 
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "hash.h"
+#include "hyperloglog.h"
+#include "munit.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void
+add_range(struct HyperLogLog* h, int start, int end)
+{
+  char key[16];
+
+  for (int i = start; i < end; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    HyperLogLog_add(h, key, key_len);
+  }
+}
+
+static MunitResult
+test_HyperLogLog_new()
+{
+  // Test new starts sparse and empty
+  struct HyperLogLog* h = HyperLogLog_new(14);
+
+  munit_assert_ptr_null(h->registers);
+  munit_assert_size(h->sparse_len, ==, 0);
+  munit_assert_size(HyperLogLog_estimate(h), ==, 0);
+
+  // Teardown
+  HyperLogLog_free(h);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_HyperLogLog_estimate()
+{
+  static const int counts[] = { 10, 1000, 5000, 40000, 200000 };
+
+  for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+    // Setup, every key added twice
+    struct HyperLogLog* h = HyperLogLog_new(14);
+    add_range(h, 0, counts[c]);
+    add_range(h, 0, counts[c]);
+
+    // Test the estimate is within 3% of the distinct count, about four
+    // standard errors
+    double error =
+      ((double)HyperLogLog_estimate(h) - counts[c]) / (double)counts[c];
+    munit_assert_double(error, >, -0.03);
+    munit_assert_double(error, <, 0.03);
+
+    // Teardown
+    HyperLogLog_free(h);
+  }
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_HyperLogLog_sparse()
+{
+  // Setup
+  struct HyperLogLog* h = HyperLogLog_new(10);
+
+  // Test small counts stay sparse and sorted by register
+  add_range(h, 0, 100);
+
+  munit_assert_ptr_null(h->registers);
+  munit_assert_size(h->sparse_len, >, 90);
+  for (size_t i = 1; i < h->sparse_len; i++) {
+    munit_assert_uint32(h->sparse[i - 1] >> 6, <, h->sparse[i] >> 6);
+  }
+
+  size_t sparse_estimate = HyperLogLog_estimate(h);
+  munit_assert_size(sparse_estimate, >=, 97);
+  munit_assert_size(sparse_estimate, <=, 103);
+
+  // Test it goes dense once the entries outgrow the registers
+  add_range(h, 100, 1000);
+
+  munit_assert_ptr_not_null(h->registers);
+  munit_assert_ptr_null(h->sparse);
+
+  // Teardown
+  HyperLogLog_free(h);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_HyperLogLog_merge()
+{
+  // Setup, a sparse and a dense estimator with overlapping keys
+  struct HyperLogLog* h_a = HyperLogLog_new(12);
+  struct HyperLogLog* h_b = HyperLogLog_new(12);
+  struct HyperLogLog* h_all = HyperLogLog_new(12);
+
+  add_range(h_a, 0, 200);
+  add_range(h_b, 100, 20000);
+  add_range(h_all, 0, 20000);
+
+  // Test merging gives the same registers as adding every key to one
+  HyperLogLog_merge(h_a, h_b);
+
+  munit_assert_ptr_not_null(h_a->registers);
+  munit_assert_memory_equal(4096, h_a->registers, h_all->registers);
+
+  // Test merging sparse into dense
+  struct HyperLogLog* h_c = HyperLogLog_new(12);
+  add_range(h_c, 0, 200);
+  HyperLogLog_merge(h_b, h_c);
+
+  munit_assert_memory_equal(4096, h_b->registers, h_all->registers);
+
+  // Teardown
+  HyperLogLog_free(h_a);
+  HyperLogLog_free(h_b);
+  HyperLogLog_free(h_c);
+  HyperLogLog_free(h_all);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_HyperLogLog_serialize()
+{
+  static const int counts[] = { 50, 50000 };
+
+  for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+    // Setup
+    struct HyperLogLog* h = HyperLogLog_new_with_hash(12, wyhash, 42);
+    add_range(h, 0, counts[c]);
+
+    size_t size = HyperLogLog_serialized_size(h);
+    uint8_t* data = malloc(size);
+    HyperLogLog_serialize(h, data);
+
+    // Test a round trip keeps the estimate and seed
+    struct HyperLogLog* copy = HyperLogLog_deserialize(data, size, wyhash);
+
+    munit_assert_ptr_not_null(copy);
+    munit_assert_uint64(copy->seed, ==, 42);
+    munit_assert_size(HyperLogLog_estimate(copy), ==, HyperLogLog_estimate(h));
+
+    // Test truncated or corrupt data is rejected
+    munit_assert_ptr_null(HyperLogLog_deserialize(data, size - 1, wyhash));
+    data[0] = 30;
+    munit_assert_ptr_null(HyperLogLog_deserialize(data, size, wyhash));
+
+    // Teardown
+    free(data);
+    HyperLogLog_free(copy);
+    HyperLogLog_free(h);
+  }
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_HyperLogLog_add_iterator()
+{
+  // Setup
+  struct Set* s = Set_new(16);
+  char* keys[1000];
+  size_t key_lens[1000];
+  char data[1000][16];
+
+  for (int i = 0; i < 1000; i++) {
+    key_lens[i] = (size_t)snprintf(data[i], sizeof(data[i]), "key-%d", i);
+    keys[i] = data[i];
+    Set_put(s, keys[i], key_lens[i]);
+  }
+
+  // Test the set's cached hashes give the same registers as the keys
+  struct HyperLogLog* h_set = HyperLogLog_new(10);
+  struct HyperLogLog* h_keys = HyperLogLog_new(10);
+
+  struct SetIterator* iterator = SetIterator_new(s);
+  HyperLogLog_add_iterator(h_set, iterator);
+  HyperLogLog_add_keys(h_keys, keys, key_lens, 1000);
+
+  munit_assert_memory_equal(1024, h_set->registers, h_keys->registers);
+
+  // Teardown
+  SetIterator_free(iterator);
+  HyperLogLog_free(h_set);
+  HyperLogLog_free(h_keys);
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_HyperLogLog_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/estimate", test_HyperLogLog_estimate, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/sparse", test_HyperLogLog_sparse, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/merge", test_HyperLogLog_merge, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/serialize", test_HyperLogLog_serialize, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/add_iterator", test_HyperLogLog_add_iterator, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/HyperLogLog", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "map.h"
+#include "munit.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdio.h>
+
+static MunitResult
+test_Map_new()
+{
+  // Test new
+  struct Map* m = Map_new(16);
+
+  munit_assert_size(m->set->capacity, ==, 16);
+  munit_assert_size(m->set->load, ==, 0);
+
+  // Teardown
+  Map_free(m);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Map_put()
+{
+  // Setup
+  struct Map* m = Map_new(4);
+  int values[100];
+  char key[16];
+
+  // Test put, including through several resizes
+  for (int i = 0; i < 100; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Map_put(m, key, key_len, &values[i]);
+  }
+
+  munit_assert_size(m->set->load, ==, 100);
+
+  for (int i = 0; i < 100; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_ptr(Map_get(m, key, key_len), ==, &values[i]);
+  }
+
+  // Test put replaces the value of an existing key
+  Map_put(m, "key-7", 5, &values[0]);
+
+  munit_assert_size(m->set->load, ==, 100);
+  munit_assert_ptr(Map_get(m, "key-7", 5), ==, &values[0]);
+
+  // Teardown
+  Map_free(m);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Map_get()
+{
+  // Setup
+  struct Map* m = Map_new(16);
+  int value = 1;
+
+  Map_put(m, "apple", 5, &value);
+
+  // Test get
+  munit_assert_ptr(Map_get(m, "apple", 5), ==, &value);
+  munit_assert_ptr(Map_get(m, "banana", 6), ==, NULL);
+
+  // Teardown
+  Map_free(m);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Map_get_or_insert()
+{
+  // Setup
+  struct Map* m = Map_new(16);
+  int first = 1;
+  int second = 2;
+
+  // Test get or insert adds a missing key
+  munit_assert_ptr(Map_get_or_insert(m, "apple", 5, &first), ==, &first);
+
+  // Test get or insert keeps the value of an existing key
+  munit_assert_ptr(Map_get_or_insert(m, "apple", 5, &second), ==, &first);
+  munit_assert_ptr(Map_get(m, "apple", 5), ==, &first);
+  munit_assert_size(m->set->load, ==, 1);
+
+  // Teardown
+  Map_free(m);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Map_delete()
+{
+  // Setup
+  struct Map* m = Map_new(16);
+  int value = 1;
+
+  Map_put(m, "apple", 5, &value);
+  Map_put(m, "a much longer key that is not inline", 36, &value);
+
+  // Test delete
+  munit_assert_ptr(Map_delete(m, "apple", 5), ==, &value);
+  munit_assert_ptr(Map_delete(m, "apple", 5), ==, NULL);
+  munit_assert_ptr(
+    Map_delete(m, "a much longer key that is not inline", 36), ==, &value);
+
+  munit_assert_size(m->set->load, ==, 0);
+  munit_assert_ptr(Map_get(m, "apple", 5), ==, NULL);
+
+  // Teardown
+  Map_free(m);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_MapIterator()
+{
+  // Setup
+  struct Map* m = Map_new(16);
+  int values[10];
+  char key[16];
+
+  for (int i = 0; i < 10; i++) {
+    values[i] = i;
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Map_put(m, key, key_len, &values[i]);
+  }
+
+  // Test iterator visits every entry with its value
+  struct MapIterator* iterator = MapIterator_new(m);
+
+  int seen = 0;
+  int sum = 0;
+  for (struct SetItem* item = MapIterator_next(iterator); item != NULL;
+       item = MapIterator_next(iterator)) {
+    munit_assert_ptr(
+      Map_get(m, item->key, item->key_len), ==, iterator->value);
+    sum += *(int*)iterator->value;
+    seen += 1;
+  }
+
+  munit_assert_int(seen, ==, 10);
+  munit_assert_int(sum, ==, 45);
+
+  // Teardown
+  MapIterator_free(iterator);
+  Map_free(m);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_Map_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/put", test_Map_put, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/get", test_Map_get, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/get_or_insert", test_Map_get_or_insert, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/delete", test_Map_delete, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/iterator", test_MapIterator, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/Map", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
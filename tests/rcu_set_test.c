@@ -0,0 +1,224 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "hash.h"
+#include "munit.h"
+#include "rcu_set.h"
+#include "set.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+
+static MunitResult
+test_RcuSet_put()
+{
+  // Setup
+  struct RcuSet* s = RcuSet_new(16, 2, SET_SWISS_TABLE, wyhash, 0);
+  char key[16];
+
+  // Test put, has and delete
+  for (int i = 0; i < 100; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    RcuSet_put(s, key, key_len);
+  }
+  for (int i = 0; i < 100; i += 2) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    RcuSet_delete(s, key, key_len);
+  }
+
+  for (int i = 0; i < 100; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(RcuSet_has(s, i % 2, key, key_len), ==, i % 2);
+  }
+
+  // Test unchanged writes do not publish a new set
+  uint64_t epoch = atomic_load(&s->epoch);
+  RcuSet_put(s, "key-1", 5);
+  RcuSet_delete(s, "key-0", 5);
+
+  munit_assert_uint64(atomic_load(&s->epoch), ==, epoch);
+
+  // Teardown
+  RcuSet_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_RcuSet_reclaim()
+{
+  // Setup
+  struct RcuSet* s = RcuSet_new(16, 2, 0, wyhash, 0);
+
+  // Test replaced sets are freed straight away without readers
+  RcuSet_put(s, "a", 1);
+  munit_assert_ptr_null(s->retired);
+
+  // Test a reader inside the set holds back every set it could have loaded
+  // since it entered
+  atomic_store(&s->readers[1].epoch, atomic_load(&s->epoch));
+  struct Set* seen = atomic_load(&s->current);
+
+  RcuSet_put(s, "b", 1);
+  RcuSet_put(s, "c", 1);
+
+  munit_assert_ptr_not_null(s->retired);
+  munit_assert_ptr_not_null(s->retired->next);
+  munit_assert_ptr_null(s->retired->next->next);
+  munit_assert_ptr(s->retired->next->set, ==, seen);
+  munit_assert_int(Set_has(seen, "a", 1), ==, 1);
+
+  // Test the set is freed on the next write once the reader leaves
+  atomic_store(&s->readers[1].epoch, 0);
+  RcuSet_delete(s, "c", 1);
+
+  munit_assert_ptr_null(s->retired);
+
+  // Test replace publishes a whole set
+  struct Set* next = Set_new(16);
+  Set_put(next, "z", 1);
+  RcuSet_replace(s, next);
+
+  munit_assert_int(RcuSet_has(s, 0, "z", 1), ==, 1);
+  munit_assert_int(RcuSet_has(s, 0, "a", 1), ==, 0);
+
+  // Teardown
+  RcuSet_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_RcuSet_incremental_resize()
+{
+  // Test SET_INCREMENTAL_RESIZE is dropped from the options
+  struct RcuSet* s =
+    RcuSet_new(16, 1, SET_INCREMENTAL_RESIZE | SET_ROBIN_HOOD, wyhash, 0);
+  struct Set* current = atomic_load(&s->current);
+
+  munit_assert_uint(current->flags & SET_INCREMENTAL_RESIZE, ==, 0);
+  munit_assert_uint(current->flags & SET_ROBIN_HOOD, ==, SET_ROBIN_HOOD);
+
+  // Test replace finishes a pending resize before publishing
+  struct Set* next =
+    Set_new_with_options(16, SET_INCREMENTAL_RESIZE, wyhash, 0);
+  char key[16];
+
+  for (int i = 0; i < 100; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(next, key, key_len);
+  }
+  munit_assert_ptr_not_null(next->resize_from);
+
+  RcuSet_replace(s, next);
+
+  munit_assert_ptr_null(next->resize_from);
+  munit_assert_uint(next->flags & SET_INCREMENTAL_RESIZE, ==, 0);
+
+  for (int i = 0; i < 100; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(RcuSet_has(s, 0, key, key_len), ==, 1);
+  }
+
+  // Teardown
+  RcuSet_free(s);
+
+  return MUNIT_OK;
+}
+
+struct reader
+{
+  struct RcuSet* s;
+  size_t idx;
+  int missing;
+};
+
+static void*
+reader_run(void* arg)
+{
+  struct reader* r = arg;
+  char key[16];
+
+  // Keys below 100 are never deleted, so every lookup must find them
+  for (int round = 0; round < 200; round++) {
+    for (int i = 0; i < 100; i++) {
+      int key_len = snprintf(key, sizeof(key), "key-%d", i);
+      r->missing += !RcuSet_has(r->s, r->idx, key, key_len);
+    }
+  }
+
+  return NULL;
+}
+
+static MunitResult
+test_RcuSet_threads()
+{
+  // Setup
+  struct RcuSet* s = RcuSet_new(16, 4, 0, wyhash, 0);
+  struct reader readers[4];
+  pthread_t threads[4];
+  char key[16];
+
+  for (int i = 0; i < 100; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    RcuSet_put(s, key, key_len);
+  }
+
+  // Test readers keep seeing a whole set while a writer swaps sets
+  for (size_t i = 0; i < 4; i++) {
+    readers[i] = (struct reader){ .s = s, .idx = i, .missing = 0 };
+    pthread_create(&threads[i], NULL, reader_run, &readers[i]);
+  }
+
+  for (int i = 100; i < 300; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    RcuSet_put(s, key, key_len);
+    if (i % 3 == 0) {
+      RcuSet_delete(s, key, key_len);
+    }
+  }
+
+  for (size_t i = 0; i < 4; i++) {
+    pthread_join(threads[i], NULL);
+    munit_assert_int(readers[i].missing, ==, 0);
+  }
+
+  // Teardown
+  RcuSet_free(s);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/put", test_RcuSet_put, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/reclaim", test_RcuSet_reclaim, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/incremental_resize", test_RcuSet_incremental_resize, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/threads", test_RcuSet_threads, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/RcuSet", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
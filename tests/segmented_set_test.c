@@ -0,0 +1,101 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "hash.h"
+#include "munit.h"
+#include "segmented_set.h"
+#include "set.h"
+#include <stddef.h>
+#include <stdint.h>
+
+static MunitResult
+test_SegmentedSet_init()
+{
+  // Test init rounds the segment count up and splits the capacity
+  struct SegmentedSet s;
+  SegmentedSet_init(&s, 100, 5, SET_POW2_CAPACITY, wyhash, 7);
+
+  munit_assert_size(s.segment_count, ==, 8);
+  munit_assert_uint(s.segment_bits, ==, 3);
+  munit_assert_uint64(s.seed, ==, 7);
+  munit_assert_size((uintptr_t)s.segments % 64, ==, 0);
+
+  for (size_t i = 0; i < s.segment_count; i++) {
+    munit_assert_size(s.segments[i].set->capacity, ==, 16);
+    munit_assert_uint(s.segments[i].set->flags, ==, SET_POW2_CAPACITY);
+  }
+
+  SegmentedSet_destroy(&s);
+
+  // Test small capacities still give each segment room for a key
+  SegmentedSet_init(&s, 0, 4, 0, wyhash, 0);
+
+  for (size_t i = 0; i < s.segment_count; i++) {
+    munit_assert_size(s.segments[i].set->capacity, ==, 2);
+  }
+
+  // Teardown
+  SegmentedSet_destroy(&s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_SegmentedSet_segment()
+{
+  // Test one segment owns every hash
+  struct SegmentedSet s;
+  SegmentedSet_init(&s, 16, 1, 0, wyhash, 0);
+
+  munit_assert_uint(s.segment_bits, ==, 0);
+  munit_assert_ptr_equal(SegmentedSet_segment(&s, UINT64_MAX), &s.segments[0]);
+
+  SegmentedSet_destroy(&s);
+
+  // Test the top bits of the hash pick the segment
+  SegmentedSet_init(&s, 16, 4, 0, wyhash, 0);
+
+  munit_assert_ptr_equal(SegmentedSet_segment(&s, 0), &s.segments[0]);
+  munit_assert_ptr_equal(SegmentedSet_segment(&s, (uint64_t)1 << 62),
+                         &s.segments[1]);
+  munit_assert_ptr_equal(SegmentedSet_segment(&s, UINT64_MAX >> 2),
+                         &s.segments[0]);
+  munit_assert_ptr_equal(SegmentedSet_segment(&s, UINT64_MAX),
+                         &s.segments[3]);
+
+  // Teardown
+  SegmentedSet_destroy(&s);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/init", test_SegmentedSet_init, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/segment", test_SegmentedSet_segment, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/SegmentedSet", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -20,6 +20,7 @@
 #include "munit.h"
 #include "set.h"
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
 static MunitResult
@@ -41,6 +42,202 @@ test_Set_new()
   return MUNIT_OK;
 }
 
+static uint64_t
+zero_hash(char* data, size_t data_len, uint64_t seed)
+{
+  (void)data;
+  (void)data_len;
+
+  return seed;
+}
+
+static MunitResult
+test_Set_new_with_hash()
+{
+  // Test new with hash
+  struct Set* s = Set_new_with_hash(4, fnv_1a_hash_seeded, 7);
+
+  munit_assert_size(s->capacity, ==, 4);
+  munit_assert_size(s->load, ==, 0);
+  munit_assert_ptr(s->hash, ==, fnv_1a_hash_seeded);
+  munit_assert_uint64(s->seed, ==, 7);
+
+  Set_put(s, "a", 1);
+  Set_put(s, "b", 1);
+
+  munit_assert_int(Set_has(s, "a", 1), ==, 1);
+  munit_assert_int(Set_has(s, "b", 1), ==, 1);
+  munit_assert_int(Set_has(s, "c", 1), ==, 0);
+
+  Set_free(s);
+
+  // The CRC hash works with layouts that index by the high or low bits
+  char key[16];
+  unsigned int flags[] = { 0, SET_POW2_CAPACITY, SET_SWISS_TABLE };
+  for (size_t f = 0; f < 3; f++) {
+    s = Set_new_with_options(4, flags[f], crc32c_hash, 7);
+    for (int i = 0; i < 1000; i++) {
+      int key_len = snprintf(key, sizeof(key), "key-%d", i);
+      Set_put(s, key, key_len);
+    }
+
+    munit_assert_size(s->load, ==, 1000);
+    for (int i = 0; i < 1000; i++) {
+      int key_len = snprintf(key, sizeof(key), "key-%d", i);
+      munit_assert_int(Set_has(s, key, key_len), ==, 1);
+    }
+
+    Set_free(s);
+  }
+
+  // Every key hashes to the seed, so keys probe linearly from slot 1
+  s = Set_new_with_hash(4, zero_hash, 1);
+
+  Set_put(s, "a", 1);
+  Set_put(s, "b", 1);
+  Set_put(s, "c", 1);
+
+  munit_assert_ptr_null(s->table[0].key);
+  munit_assert_memory_equal(1, s->table[1].key, "a");
+  munit_assert_memory_equal(1, s->table[2].key, "b");
+  munit_assert_memory_equal(1, s->table[3].key, "c");
+
+  munit_assert_int(Set_has(s, "c", 1), ==, 1);
+  munit_assert_int(Set_has(s, "d", 1), ==, 0);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_new_with_options()
+{
+  // Test capacity is rounded up to a power of two
+  struct Set* s = Set_new_with_options(5, SET_POW2_CAPACITY, wyhash, 0);
+
+  munit_assert_size(s->capacity, ==, 8);
+  munit_assert_size(s->load, ==, 0);
+  munit_assert_uint(s->flags, ==, SET_POW2_CAPACITY);
+  munit_assert_uint(s->shift, ==, 61);
+
+  for (size_t i = 0; i < s->capacity; i++) {
+    munit_assert_ptr(s->table[i].key, ==, NULL);
+  }
+
+  Set_free(s);
+
+  s = Set_new_with_options(128, SET_POW2_CAPACITY, wyhash, 0);
+
+  munit_assert_size(s->capacity, ==, 128);
+  munit_assert_uint(s->shift, ==, 57);
+
+  Set_free(s);
+
+  // Test expanding keeps the capacity a power of two
+  s = Set_new_with_options(2, SET_POW2_CAPACITY, wyhash, 0);
+
+  char key[16];
+  for (int i = 0; i < 100; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(s, key, key_len);
+  }
+
+  munit_assert_size(s->capacity, ==, 256);
+  munit_assert_uint(s->shift, ==, 56);
+  munit_assert_size(s->load, ==, 100);
+
+  for (int i = 0; i < 100; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(Set_has(s, key, key_len), ==, 1);
+  }
+  munit_assert_int(Set_has(s, "key-100", 7), ==, 0);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_swiss_table()
+{
+  // Test new rounds up to a full control group
+  struct Set* s = Set_new_with_options(5, SET_SWISS_TABLE, wyhash, 0);
+
+  munit_assert_size(s->capacity, ==, 16);
+  munit_assert_uint(s->flags, ==, SET_SWISS_TABLE | SET_POW2_CAPACITY);
+  munit_assert_ptr_not_null(s->ctrl);
+
+  for (size_t i = 0; i < s->capacity + 16; i++) {
+    munit_assert_uint(s->ctrl[i], ==, 0x80);
+  }
+
+  // Test put, has and delete across several expansions
+  char key[16];
+  for (int i = 0; i < 1000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(s, key, key_len);
+    Set_put(s, key, key_len);
+  }
+
+  munit_assert_size(s->load, ==, 1000);
+  munit_assert_size(s->capacity, ==, 2048);
+
+  for (int i = 0; i < 1000; i += 2) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_delete(s, key, key_len);
+  }
+
+  munit_assert_size(s->load, ==, 500);
+  munit_assert_size(s->deleted, ==, 500);
+
+  for (int i = 0; i < 1000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(Set_has(s, key, key_len), ==, i % 2);
+  }
+
+  size_t count = 0;
+  struct SetIterator* iterator = SetIterator_new(s);
+  while (SetIterator_next(iterator) != NULL) {
+    count += 1;
+  }
+  SetIterator_free(iterator);
+
+  munit_assert_size(count, ==, 500);
+
+  Set_free(s);
+
+  // Test colliding keys probe past full groups and reuse deleted slots
+  s = Set_new_with_options(64, SET_SWISS_TABLE, zero_hash, 0);
+
+  for (int i = 0; i < 40; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(s, key, key_len);
+  }
+
+  munit_assert_size(s->capacity, ==, 64);
+
+  for (int i = 0; i < 40; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(Set_has(s, key, key_len), ==, 1);
+  }
+  munit_assert_int(Set_has(s, "key-40", 6), ==, 0);
+
+  Set_delete(s, "key-3", 5);
+  Set_put(s, "key-40", 6);
+
+  munit_assert_size(s->deleted, ==, 0);
+  munit_assert_int(Set_has(s, "key-3", 5), ==, 0);
+  munit_assert_int(Set_has(s, "key-40", 6), ==, 1);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
 static MunitResult
 test_Set_put()
 {
@@ -58,25 +255,25 @@ test_Set_put()
 
   munit_assert_ptr_null(s->table[0].key);
 
-  munit_assert_ptr_not_null(s->table[1].key);
-  munit_assert_memory_equal(1, s->table[1].key, "a");
-  munit_assert_size(s->table[1].key_len, ==, 1);
+  munit_assert_ptr_null(s->table[1].key);
 
-  munit_assert_ptr_null(s->table[2].key);
+  munit_assert_ptr_not_null(s->table[2].key);
+  munit_assert_memory_equal(1, s->table[2].key, "a");
+  munit_assert_size(s->table[2].key_len, ==, 1);
 
   Set_put(s, "b", 1);
 
   munit_assert_size(s->capacity, ==, 3);
   munit_assert_size(s->load, ==, 2);
 
-  munit_assert_ptr_null(s->table[0].key);
+  munit_assert_ptr_not_null(s->table[0].key);
+  munit_assert_memory_equal(1, s->table[0].key, "b");
+  munit_assert_size(s->table[0].key_len, ==, 1);
 
-  munit_assert_ptr_not_null(s->table[1].key);
-  munit_assert_memory_equal(1, s->table[1].key, "a");
-  munit_assert_size(s->table[1].key_len, ==, 1);
+  munit_assert_ptr_null(s->table[1].key);
 
   munit_assert_ptr_not_null(s->table[2].key);
-  munit_assert_memory_equal(1, s->table[2].key, "b");
+  munit_assert_memory_equal(1, s->table[2].key, "a");
   munit_assert_size(s->table[2].key_len, ==, 1);
 
   Set_put(s, "c", 1);
@@ -85,15 +282,15 @@ test_Set_put()
   munit_assert_size(s->load, ==, 3);
 
   munit_assert_ptr_not_null(s->table[0].key);
-  munit_assert_memory_equal(1, s->table[0].key, "c");
+  munit_assert_memory_equal(1, s->table[0].key, "b");
   munit_assert_size(s->table[0].key_len, ==, 1);
 
   munit_assert_ptr_not_null(s->table[1].key);
-  munit_assert_memory_equal(1, s->table[1].key, "a");
+  munit_assert_memory_equal(1, s->table[1].key, "c");
   munit_assert_size(s->table[1].key_len, ==, 1);
 
   munit_assert_ptr_not_null(s->table[2].key);
-  munit_assert_memory_equal(1, s->table[2].key, "b");
+  munit_assert_memory_equal(1, s->table[2].key, "a");
   munit_assert_size(s->table[2].key_len, ==, 1);
 
   Set_put(s, "d", 1);
@@ -102,24 +299,265 @@ test_Set_put()
   munit_assert_size(s->load, ==, 4);
 
   munit_assert_ptr_not_null(s->table[0].key);
-  munit_assert_memory_equal(1, s->table[0].key, "c");
+  munit_assert_memory_equal(1, s->table[0].key, "d");
   munit_assert_size(s->table[0].key_len, ==, 1);
 
   munit_assert_ptr_not_null(s->table[1].key);
-  munit_assert_memory_equal(1, s->table[1].key, "b");
+  munit_assert_memory_equal(1, s->table[1].key, "c");
   munit_assert_size(s->table[1].key_len, ==, 1);
 
   munit_assert_ptr_not_null(s->table[2].key);
-  munit_assert_memory_equal(1, s->table[2].key, "d");
+  munit_assert_memory_equal(1, s->table[2].key, "b");
   munit_assert_size(s->table[2].key_len, ==, 1);
 
-  munit_assert_ptr_null(s->table[3].key);
+  munit_assert_ptr_not_null(s->table[3].key);
+  munit_assert_memory_equal(1, s->table[3].key, "a");
+  munit_assert_size(s->table[3].key_len, ==, 1);
+
+  munit_assert_ptr_null(s->table[4].key);
+
+  munit_assert_ptr_null(s->table[5].key);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static size_t counting_hash_calls = 0;
+
+static uint64_t
+counting_hash(char* data, size_t data_len, uint64_t seed)
+{
+  counting_hash_calls += 1;
+
+  return wyhash(data, data_len, seed);
+}
+
+static MunitResult
+test_Set_cached_hash()
+{
+  // Setup
+  counting_hash_calls = 0;
+  struct Set* s = Set_new_with_hash(3, counting_hash, 0);
+
+  // Test the hash is computed once per call and not on expand
+  Set_put(s, "a", 1);
+  Set_put(s, "b", 1);
+  Set_put(s, "c", 1);
+  Set_put(s, "d", 1);
+
+  munit_assert_size(s->capacity, ==, 6);
+  munit_assert_size(counting_hash_calls, ==, 4);
+
+  for (size_t i = 0; i < s->capacity; i++) {
+    if (s->table[i].key != NULL) {
+      munit_assert_uint64(s->table[i].hash,
+                          ==,
+                          wyhash(s->table[i].key, s->table[i].key_len, 0));
+    }
+  }
+
+  Set_delete(s, "a", 1);
+
+  munit_assert_size(counting_hash_calls, ==, 5);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_inline_keys()
+{
+  // Setup
+  struct Set* s = Set_new(4);
+
+  char* short_key = "exactly-twenty-bytes";
+  char* long_key = "twenty-one-bytes-long";
+
+  munit_assert_size(strlen(short_key), ==, SET_INLINE_KEY_LEN);
+
+  // Test short keys point into their slot and long keys do not
+  Set_put(s, short_key, strlen(short_key));
+  Set_put(s, long_key, strlen(long_key));
+
+  struct SetIterator* iterator = SetIterator_new(s);
+  struct SetItem* item;
+  while ((item = SetIterator_next(iterator)) != NULL) {
+    if (item->key_len == SET_INLINE_KEY_LEN) {
+      munit_assert_ptr(item->key, ==, item->inline_key);
+      munit_assert_memory_equal(item->key_len, item->key, short_key);
+    } else {
+      munit_assert_ptr(item->key, !=, item->inline_key);
+      munit_assert_memory_equal(item->key_len, item->key, long_key);
+    }
+  }
+  SetIterator_free(iterator);
+
+  // Test inline keys follow their entry when the table expands
+  Set_put(s, "a", 1);
+  Set_put(s, "b", 1);
+  Set_put(s, "c", 1);
+
+  munit_assert_size(s->capacity, ==, 8);
+
+  for (size_t i = 0; i < s->capacity; i++) {
+    if (s->table[i].key != NULL && s->table[i].key_len <= SET_INLINE_KEY_LEN) {
+      munit_assert_ptr(s->table[i].key, ==, s->table[i].inline_key);
+    }
+  }
+
+  munit_assert_int(Set_has(s, short_key, strlen(short_key)), ==, 1);
+  munit_assert_int(Set_has(s, long_key, strlen(long_key)), ==, 1);
+  munit_assert_int(Set_has(s, "a", 1), ==, 1);
+  munit_assert_int(Set_has(s, "b", 1), ==, 1);
+  munit_assert_int(Set_has(s, "c", 1), ==, 1);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_arena_keys()
+{
+  // Setup
+  struct Set* s = Set_new_with_options(4, SET_ARENA_KEYS, wyhash, 0);
+
+  munit_assert_ptr_not_null(s->arena);
+
+  // Test long keys are packed into the arena
+  char key[64];
+  for (int i = 0; i < 100; i++) {
+    int key_len =
+      snprintf(key, sizeof(key), "a-key-long-enough-for-the-arena-%d", i);
+    Set_put(s, key, key_len);
+  }
+
+  munit_assert_size(s->load, ==, 100);
+  munit_assert_ptr_not_null(s->arena->chunk);
+  munit_assert_ptr_null(s->arena->chunk->next);
+
+  for (size_t i = 0; i < s->capacity; i++) {
+    struct SetItem* item = &s->table[i];
+    if (item->key != NULL) {
+      munit_assert_ptr(item->key, >=, s->arena->chunk->data);
+      munit_assert_ptr(
+        item->key, <, s->arena->chunk->data + s->arena->chunk->length);
+    }
+  }
+
+  // Test delete and re-insert
+  for (int i = 0; i < 100; i += 2) {
+    int key_len =
+      snprintf(key, sizeof(key), "a-key-long-enough-for-the-arena-%d", i);
+    Set_delete(s, key, key_len);
+  }
+
+  munit_assert_size(s->load, ==, 50);
+
+  for (int i = 0; i < 100; i++) {
+    int key_len =
+      snprintf(key, sizeof(key), "a-key-long-enough-for-the-arena-%d", i);
+    munit_assert_int(Set_has(s, key, key_len), ==, i % 2);
+  }
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_incremental_resize()
+{
+  // Setup
+  struct Set* s = Set_new_with_options(
+    64, SET_INCREMENTAL_RESIZE | SET_POW2_CAPACITY, wyhash, 0);
+
+  char key[16];
+  for (int i = 0; i < 49; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(s, key, key_len);
+  }
+
+  munit_assert_size(s->capacity, ==, 64);
+  munit_assert_ptr_null(s->resize_from);
+
+  // Test crossing the load threshold starts moving entries
+  Set_put(s, "key-49", 6);
+
+  munit_assert_size(s->capacity, ==, 128);
+  munit_assert_size(s->load, ==, 50);
+  munit_assert_ptr_not_null(s->resize_from);
+  munit_assert_size(s->resize_from->capacity, ==, 64);
+  munit_assert_size(s->resize_idx, <=, 32);
+
+  // Test keys are found and deleted in either table mid-resize
+  for (int i = 0; i < 50; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(Set_has(s, key, key_len), ==, 1);
+  }
+
+  munit_assert_ptr_null(s->resize_from);
+
+  for (int i = 50; i < 98; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(s, key, key_len);
+  }
+
+  munit_assert_size(s->capacity, ==, 256);
+  munit_assert_ptr_not_null(s->resize_from);
+
+  for (int i = 0; i < 98; i += 2) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_delete(s, key, key_len);
+  }
+
+  munit_assert_size(s->load, ==, 49);
+
+  for (int i = 0; i < 98; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(Set_has(s, key, key_len), ==, i % 2);
+  }
 
-  munit_assert_ptr_not_null(s->table[4].key);
-  munit_assert_memory_equal(1, s->table[4].key, "a");
-  munit_assert_size(s->table[4].key_len, ==, 1);
+  munit_assert_ptr_null(s->resize_from);
 
-  munit_assert_ptr_null(s->table[3].key);
+  // Test iterating finishes the resize first
+  Set_put(s, "key-150", 7);
+  for (int i = 151; s->resize_from == NULL; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(s, key, key_len);
+  }
+
+  size_t load = s->load;
+  size_t count = 0;
+  struct SetIterator* iterator = SetIterator_new(s);
+
+  munit_assert_ptr_null(s->resize_from);
+
+  while (SetIterator_next(iterator) != NULL) {
+    count += 1;
+  }
+  SetIterator_free(iterator);
+
+  munit_assert_size(count, ==, load);
+
+  // Test Set_finish_resize moves every entry left in the old table
+  for (int i = (int)load + 200; s->resize_from == NULL; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(s, key, key_len);
+  }
+
+  load = s->load;
+  Set_finish_resize(s);
+
+  munit_assert_ptr_null(s->resize_from);
+  munit_assert_size(s->load, ==, load);
+  munit_assert_int(Set_has(s, "key-150", 7), ==, 1);
 
   // Teardown
   Set_free(s);
@@ -158,6 +596,168 @@ test_Set_has()
   return MUNIT_OK;
 }
 
+static MunitResult
+test_Set_get()
+{
+  // Setup
+  struct Set* s = Set_new_with_options(8, SET_VALUES, wyhash, 0);
+  int value = 1;
+
+  struct SetItem* put = Set_put(s, "a", 1);
+  munit_assert_ptr(*Set_value(s, put), ==, NULL);
+  *Set_value(s, put) = &value;
+
+  // Test get returns the slot with its value
+  struct SetItem* item = Set_get(s, "a", 1);
+  munit_assert_ptr(item, ==, put);
+  munit_assert_ptr(*Set_value(s, item), ==, &value);
+
+  // Test put of an existing key returns the same slot
+  munit_assert_ptr(Set_put(s, "a", 1), ==, item);
+  munit_assert_ptr(Set_get(s, "b", 1), ==, NULL);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_insert_or_find()
+{
+  // Setup
+  counting_hash_calls = 0;
+  struct Set* s = Set_new_with_options(8, 0, counting_hash, 0);
+  int inserted;
+
+  // Test a new key is inserted with one hash
+  struct SetItem* item = Set_insert_or_find(s, "a", 1, &inserted);
+  munit_assert_int(inserted, ==, 1);
+  munit_assert_size(s->load, ==, 1);
+  munit_assert_size(counting_hash_calls, ==, 1);
+
+  // Test an existing key is found with one hash
+  munit_assert_ptr(Set_insert_or_find(s, "a", 1, &inserted), ==, item);
+  munit_assert_int(inserted, ==, 0);
+  munit_assert_size(s->load, ==, 1);
+  munit_assert_size(counting_hash_calls, ==, 2);
+
+  // Test a precomputed hash is used as is
+  uint64_t hash = wyhash("b", 1, 0);
+  item = Set_insert_or_find_hashed(s, "b", 1, hash, &inserted);
+  munit_assert_int(inserted, ==, 1);
+  munit_assert_uint64(item->hash, ==, hash);
+  munit_assert_size(counting_hash_calls, ==, 2);
+  munit_assert_int(Set_has(s, "b", 1), ==, 1);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_values()
+{
+  static const unsigned int flags[] = {
+    0, SET_SWISS_TABLE, SET_ROBIN_HOOD, SET_INCREMENTAL_RESIZE
+  };
+
+  // Test plain sets keep 48 byte slots and values sit after their item
+  struct Set* plain = Set_new(8);
+
+  munit_assert_size(sizeof(struct SetItem), ==, 48);
+  munit_assert_size(plain->item_size, ==, sizeof(struct SetItem));
+  munit_assert_size(sizeof(struct SetValueItem), ==, 56);
+
+  Set_free(plain);
+
+  for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+    // Setup, enough keys to resize several times
+    struct Set* s = Set_new_with_options(4, flags[f] | SET_VALUES, wyhash, 0);
+    int values[2000];
+    char key[16];
+
+    for (int i = 0; i < 2000; i++) {
+      int key_len = snprintf(key, sizeof(key), "key-%d", i);
+      struct SetItem* item = Set_put(s, key, key_len);
+      *Set_value(s, item) = &values[i];
+      munit_assert_ptr((char*)Set_value(s, item), ==, (char*)item + 48);
+    }
+
+    munit_assert_size(s->item_size, ==, sizeof(struct SetValueItem));
+
+    // Test values follow their keys through resizes and deletes
+    for (int i = 0; i < 2000; i += 3) {
+      int key_len = snprintf(key, sizeof(key), "key-%d", i);
+      munit_assert_ptr(Set_delete_value(s, key, key_len), ==, &values[i]);
+      munit_assert_ptr_null(Set_delete_value(s, key, key_len));
+    }
+
+    struct Set* copy = Set_copy(s);
+    for (int i = 0; i < 2000; i++) {
+      int key_len = snprintf(key, sizeof(key), "key-%d", i);
+      struct SetItem* item = Set_get(s, key, key_len);
+      if (i % 3 == 0) {
+        munit_assert_ptr_null(item);
+        continue;
+      }
+      munit_assert_ptr(*Set_value(s, item), ==, &values[i]);
+      item = Set_get(copy, key, key_len);
+      munit_assert_ptr(*Set_value(copy, item), ==, &values[i]);
+    }
+
+    // Teardown
+    Set_free(copy);
+    Set_free(s);
+  }
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_batch()
+{
+  static const unsigned int flags[] = {
+    0, SET_SWISS_TABLE, SET_ROBIN_HOOD, SET_INCREMENTAL_RESIZE
+  };
+
+  for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+    // Setup, more keys than one batch and enough to resize part way through
+    struct Set* s = Set_new_with_options(16, flags[f], wyhash, 0);
+    char data[100][16];
+    char* keys[100];
+    size_t key_lens[100];
+    int results[100];
+
+    for (int i = 0; i < 100; i++) {
+      key_lens[i] = (size_t)snprintf(data[i], sizeof(data[i]), "key-%d", i);
+      keys[i] = data[i];
+    }
+
+    // Test put batch counts only new keys
+    munit_assert_size(Set_put_batch(s, keys, key_lens, 50), ==, 50);
+    munit_assert_size(Set_put_batch(s, keys, key_lens, 100), ==, 50);
+    munit_assert_size(s->load, ==, 100);
+
+    for (int i = 0; i < 100; i += 2) {
+      Set_delete(s, keys[i], key_lens[i]);
+    }
+
+    // Test has batch agrees with Set_has
+    Set_has_batch(s, keys, key_lens, 100, results);
+    for (int i = 0; i < 100; i++) {
+      munit_assert_int(results[i], ==, i % 2);
+      munit_assert_int(results[i], ==, Set_has(s, keys[i], key_lens[i]));
+    }
+
+    // Teardown
+    Set_free(s);
+  }
+
+  return MUNIT_OK;
+}
+
 static MunitResult
 test_Set_delete()
 {
@@ -219,6 +819,137 @@ test_Set_delete()
   return MUNIT_OK;
 }
 
+static MunitResult
+test_Set_delete_shift()
+{
+  // Setup, every key hashes to slot 6 and wraps around the end
+  struct Set* s = Set_new_with_hash(8, zero_hash, 6);
+
+  Set_put(s, "a", 1);
+  Set_put(s, "b", 1);
+  Set_put(s, "c", 1);
+  Set_put(s, "d", 1);
+
+  munit_assert_memory_equal(1, s->table[6].key, "a");
+  munit_assert_memory_equal(1, s->table[7].key, "b");
+  munit_assert_memory_equal(1, s->table[0].key, "c");
+  munit_assert_memory_equal(1, s->table[1].key, "d");
+
+  // Test delete moves the rest of the probe sequence back
+  Set_delete(s, "b", 1);
+
+  munit_assert_size(s->load, ==, 3);
+
+  munit_assert_memory_equal(1, s->table[6].key, "a");
+  munit_assert_memory_equal(1, s->table[7].key, "c");
+  munit_assert_memory_equal(1, s->table[0].key, "d");
+  munit_assert_ptr_null(s->table[1].key);
+
+  munit_assert_int(Set_has(s, "a", 1), ==, 1);
+  munit_assert_int(Set_has(s, "b", 1), ==, 0);
+  munit_assert_int(Set_has(s, "c", 1), ==, 1);
+  munit_assert_int(Set_has(s, "d", 1), ==, 1);
+
+  Set_delete(s, "a", 1);
+
+  munit_assert_memory_equal(1, s->table[6].key, "c");
+  munit_assert_memory_equal(1, s->table[7].key, "d");
+  munit_assert_ptr_null(s->table[0].key);
+
+  munit_assert_int(Set_has(s, "c", 1), ==, 1);
+  munit_assert_int(Set_has(s, "d", 1), ==, 1);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static struct SetItem*
+table_item(struct Set* s, size_t idx)
+{
+  return (struct SetItem*)((char*)s->table + idx * s->item_size);
+}
+
+static void
+assert_robin_hood_invariant(struct Set* s)
+{
+  for (size_t i = 0; i < s->capacity; i++) {
+    struct SetItem* item = table_item(s, i);
+    if (item->key == NULL) {
+      continue;
+    }
+
+    size_t home = item->hash % s->capacity;
+    size_t dist = (i + s->capacity - home) % s->capacity;
+    munit_assert_size(item->dist, ==, dist);
+
+    // The previous slot is never further from its home by more than one
+    struct SetItem* prev = table_item(s, (i + s->capacity - 1) % s->capacity);
+    if (item->dist > 0) {
+      munit_assert_ptr_not_null(prev->key);
+      munit_assert_uint(prev->dist + 1, >=, item->dist);
+    }
+  }
+}
+
+static MunitResult
+test_Set_robin_hood()
+{
+  // Setup
+  struct Set* s = Set_new_with_options(16, SET_ROBIN_HOOD, wyhash, 0);
+
+  munit_assert_uint(s->flags, ==, SET_ROBIN_HOOD);
+
+  // Test put, has and delete keep probe distances ordered
+  char key[16];
+  for (int i = 0; i < 2000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(s, key, key_len);
+  }
+
+  munit_assert_size(s->load, ==, 2000);
+  munit_assert_size(s->capacity, ==, 4096);
+  assert_robin_hood_invariant(s);
+
+  for (int i = 0; i < 2000; i += 3) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_delete(s, key, key_len);
+  }
+
+  assert_robin_hood_invariant(s);
+
+  for (int i = 0; i < 2000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(Set_has(s, key, key_len), ==, i % 3 != 0);
+  }
+
+  // Test the 0.9 load threshold, 9 keys fill a 10 slot table to the limit
+  // and the 10th grows it
+  Set_free(s);
+  s = Set_new_with_options(10, SET_ROBIN_HOOD, wyhash, 0);
+
+  for (int i = 0; i < 9; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    Set_put(s, key, key_len);
+  }
+
+  munit_assert_size(s->capacity, ==, 10);
+  munit_assert_size(s->load, ==, 9);
+  assert_robin_hood_invariant(s);
+
+  Set_put(s, "key-9", 5);
+
+  munit_assert_size(s->capacity, ==, 20);
+  munit_assert_size(s->load, ==, 10);
+  assert_robin_hood_invariant(s);
+
+  // Teardown
+  Set_free(s);
+
+  return MUNIT_OK;
+}
+
 MunitResult
 test_Set_union()
 {
@@ -307,6 +1038,272 @@ test_Set_intersection()
   return MUNIT_OK;
 }
 
+static struct Set*
+letters_set(unsigned int flags, const char* letters)
+{
+  struct Set* s = Set_new_with_options(4, flags, wyhash, 0);
+  for (const char* c = letters; *c != '\0'; c++) {
+    Set_put(s, (char*)c, 1);
+  }
+
+  return s;
+}
+
+static void
+assert_letters(struct Set* s, const char* letters)
+{
+  munit_assert_size(s->load, ==, strlen(letters));
+  for (const char* c = letters; *c != '\0'; c++) {
+    munit_assert_int(Set_has(s, (char*)c, 1), ==, 1);
+  }
+}
+
+static MunitResult
+test_Set_copy()
+{
+  // Setup
+  struct Set* s = Set_new_with_options(4, SET_ARENA_KEYS, wyhash, 0);
+  char key[64];
+
+  for (int i = 0; i < 20; i++) {
+    int key_len = snprintf(key, sizeof(key), "a key too long to inline %d", i);
+    Set_put(s, key, key_len);
+  }
+  Set_put(s, "short", 5);
+
+  // Test the copy owns its keys and outlives the original
+  struct Set* copy = Set_copy(s);
+  Set_free(s);
+
+  munit_assert_size(copy->load, ==, 21);
+  munit_assert_int(Set_has(copy, "short", 5), ==, 1);
+  for (int i = 0; i < 20; i++) {
+    int key_len = snprintf(key, sizeof(key), "a key too long to inline %d", i);
+    munit_assert_int(Set_has(copy, key, key_len), ==, 1);
+  }
+
+  // Teardown
+  Set_free(copy);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_algebra()
+{
+  static const unsigned int flags[] = {
+    0, SET_SWISS_TABLE, SET_ROBIN_HOOD, SET_INCREMENTAL_RESIZE
+  };
+
+  for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+    // Setup
+    struct Set* s1 = letters_set(flags[f], "abcdefghij");
+    struct Set* s2 = letters_set(flags[f], "hijklm");
+    struct Set* s3 = letters_set(flags[f], "bcd");
+
+    // Test difference and symmetric difference
+    struct Set* difference = Set_difference(s1, s2);
+    assert_letters(difference, "abcdefg");
+    munit_assert_int(Set_has(difference, "h", 1), ==, 0);
+
+    struct Set* symmetric = Set_symmetric_difference(s1, s2);
+    assert_letters(symmetric, "abcdefgklm");
+
+    // Test intersection probes from the smaller side
+    struct Set* intersection = Set_intersection(s2, s1);
+    assert_letters(intersection, "hij");
+
+    // Test subset
+    munit_assert_int(Set_is_subset(s3, s1), ==, 1);
+    munit_assert_int(Set_is_subset(s1, s3), ==, 0);
+    munit_assert_int(Set_is_subset(s3, s2), ==, 0);
+
+    // Test union in place
+    Set_union_in_place(s3, s2);
+    assert_letters(s3, "bcdhijklm");
+
+    // Teardown
+    Set_free(s1);
+    Set_free(s2);
+    Set_free(s3);
+    Set_free(difference);
+    Set_free(symmetric);
+    Set_free(intersection);
+  }
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_algebra_cached_hash()
+{
+  // Setup
+  counting_hash_calls = 0;
+  struct Set* s1 = Set_new_with_hash(4, counting_hash, 0);
+  struct Set* s2 = Set_new_with_hash(4, counting_hash, 0);
+
+  Set_put(s1, "a", 1);
+  Set_put(s1, "b", 1);
+  Set_put(s2, "b", 1);
+  Set_put(s2, "c", 1);
+
+  // Test sets hashing the same way reuse the stored hashes
+  struct Set* union_s = Set_union(s1, s2);
+  struct Set* intersection = Set_intersection(s1, s2);
+
+  munit_assert_size(counting_hash_calls, ==, 4);
+  munit_assert_size(union_s->load, ==, 3);
+  munit_assert_size(intersection->load, ==, 1);
+
+  // Test a different seed hashes again
+  struct Set* s3 = Set_new_with_hash(4, counting_hash, 1);
+  Set_put(s3, "a", 1);
+  counting_hash_calls = 0;
+
+  munit_assert_int(Set_is_subset(s3, s1), ==, 1);
+  munit_assert_size(counting_hash_calls, ==, 1);
+
+  // Teardown
+  Set_free(s1);
+  Set_free(s2);
+  Set_free(s3);
+  Set_free(union_s);
+  Set_free(intersection);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_union_consume()
+{
+  static const unsigned int flags[][2] = {
+    { 0, 0 },
+    { SET_ARENA_KEYS, SET_ARENA_KEYS },
+    { SET_ARENA_KEYS, 0 },
+    { 0, SET_ARENA_KEYS | SET_SWISS_TABLE },
+  };
+
+  for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+    // Setup, keys 30 to 39 are in both sets
+    struct Set* s1 = Set_new_with_options(4, flags[f][0], wyhash, 0);
+    struct Set* s2 = Set_new_with_options(4, flags[f][1], wyhash, 0);
+    char key[64];
+
+    for (int i = 0; i < 60; i++) {
+      const char* prefix = i % 2 ? "k" : "a key too long to inline";
+      int key_len = snprintf(key, sizeof(key), "%s %d", prefix, i);
+      if (i < 40) {
+        Set_put(s1, key, key_len);
+      }
+      if (i >= 30) {
+        Set_put(s2, key, key_len);
+      }
+    }
+
+    // Test every key ends up in s1, s2 is released with the union
+    Set_union_consume(s1, s2);
+
+    munit_assert_size(s1->load, ==, 60);
+    for (int i = 0; i < 60; i++) {
+      const char* prefix = i % 2 ? "k" : "a key too long to inline";
+      int key_len = snprintf(key, sizeof(key), "%s %d", prefix, i);
+      munit_assert_int(Set_has(s1, key, key_len), ==, 1);
+    }
+
+    // Teardown
+    Set_free(s1);
+  }
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_Set_parallel()
+{
+  static const unsigned int flags[] = {
+    0,
+    SET_SWISS_TABLE,
+    SET_ROBIN_HOOD,
+    SET_INCREMENTAL_RESIZE,
+    SET_POW2_CAPACITY | SET_ARENA_KEYS | SET_VALUES,
+    SET_ROBIN_HOOD | SET_ARENA_KEYS | SET_VALUES,
+  };
+  static const size_t threads[] = { 0, 1, 3, 8, 1000 };
+
+  for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+    // Setup, keys 300 to 999 overlap and every third key is too long to
+    // be stored inline
+    struct Set* s1 = Set_new_with_options(4, flags[f], wyhash, 0);
+    struct Set* s2 = Set_new_with_options(4, flags[f], wyhash, 0);
+    int values[1500];
+    char key[64];
+
+    for (int i = 0; i < 1500; i++) {
+      int key_len = snprintf(key,
+                             sizeof(key),
+                             i % 3 ? "key-%d" : "a-key-longer-than-inline-%d",
+                             i);
+      if (i < 1000) {
+        struct SetItem* item = Set_put(s1, key, key_len);
+        if (flags[f] & SET_VALUES) {
+          *Set_value(s1, item) = &values[i];
+        }
+      }
+      if (i >= 300) {
+        Set_put(s2, key, key_len);
+      }
+    }
+
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+      // Test parallel results match the sequential ones
+      struct Set* intersection =
+        Set_intersection_parallel(s1, s2, threads[t]);
+      struct Set* union_s = Set_union_parallel(s1, s2, threads[t]);
+
+      munit_assert_size(intersection->load, ==, 700);
+      munit_assert_size(union_s->load, ==, 1500);
+      munit_assert_uint(union_s->flags, ==, s1->flags);
+
+      if (flags[f] & SET_ROBIN_HOOD) {
+        assert_robin_hood_invariant(intersection);
+        assert_robin_hood_invariant(union_s);
+      }
+
+      for (int i = 0; i < 1500; i++) {
+        int key_len = snprintf(key,
+                               sizeof(key),
+                               i % 3 ? "key-%d" : "a-key-longer-than-inline-%d",
+                               i);
+        struct SetItem* found = Set_get(intersection, key, key_len);
+        munit_assert_int(found != NULL, ==, i >= 300 && i < 1000);
+        munit_assert_not_null(Set_get(union_s, key, key_len));
+
+        if ((flags[f] & SET_VALUES) && found != NULL) {
+          munit_assert_ptr(*Set_value(intersection, found), ==, &values[i]);
+        }
+        if (flags[f] & SET_VALUES) {
+          void* value = Set_delete_value(union_s, key, key_len);
+          munit_assert_ptr(value, ==, i < 1000 ? &values[i] : NULL);
+        } else {
+          Set_delete(union_s, key, key_len);
+        }
+      }
+
+      // Test every key of the union could be found again and deleted
+      munit_assert_size(union_s->load, ==, 0);
+
+      Set_free(intersection);
+      Set_free(union_s);
+    }
+
+    // Teardown
+    Set_free(s1);
+    Set_free(s2);
+  }
+
+  return MUNIT_OK;
+}
+
 MunitResult
 test_Set_iterator()
 {
@@ -326,19 +1323,19 @@ test_Set_iterator()
 
   munit_assert_not_null(next);
   munit_assert_size(next->key_len, ==, 1);
-  munit_assert_memory_equal(1, next->key, "c");
+  munit_assert_memory_equal(1, next->key, "a");
 
   next = SetIterator_next(iterator);
 
   munit_assert_not_null(next);
   munit_assert_size(next->key_len, ==, 1);
-  munit_assert_memory_equal(1, next->key, "a");
+  munit_assert_memory_equal(1, next->key, "b");
 
   next = SetIterator_next(iterator);
 
   munit_assert_not_null(next);
   munit_assert_size(next->key_len, ==, 1);
-  munit_assert_memory_equal(1, next->key, "b");
+  munit_assert_memory_equal(1, next->key, "c");
 
   next = SetIterator_next(iterator);
 
@@ -355,9 +1352,27 @@ test_Set_iterator()
 // clang-format off
 static MunitTest test_suite_tests[] = {
   {"/new", test_Set_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/new_with_hash", test_Set_new_with_hash, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/new_with_options", test_Set_new_with_options, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/swiss_table", test_Set_swiss_table, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
   {"/put", test_Set_put, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/cached_hash", test_Set_cached_hash, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/inline_keys", test_Set_inline_keys, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/arena_keys", test_Set_arena_keys, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/incremental_resize", test_Set_incremental_resize, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
   {"/has", test_Set_has, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/get", test_Set_get, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/insert_or_find", test_Set_insert_or_find, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/values", test_Set_values, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/batch", test_Set_batch, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
   {"/delete", test_Set_delete, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/delete_shift", test_Set_delete_shift, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/robin_hood", test_Set_robin_hood, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/copy", test_Set_copy, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/algebra", test_Set_algebra, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/algebra_cached_hash", test_Set_algebra_cached_hash, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/union_consume", test_Set_union_consume, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/parallel", test_Set_parallel, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
   {"/union", test_Set_union, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
   {"/intersection", test_Set_intersection, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
   {"/iterator", test_Set_iterator, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "hash.h"
+#include "munit.h"
+#include "set.h"
+#include "sharded_set.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+
+static MunitResult
+test_ShardedSet_new()
+{
+  // Test new rounds the shard count up to a power of two
+  struct ShardedSet* s = ShardedSet_new(64, 3);
+
+  munit_assert_size(s->base.segment_count, ==, 4);
+  munit_assert_uint(s->base.segment_bits, ==, 2);
+  munit_assert_size(ShardedSet_load(s), ==, 0);
+
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    munit_assert_size(s->base.segments[i].set->capacity, ==, 16);
+  }
+
+  // Teardown
+  ShardedSet_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_ShardedSet_put()
+{
+  // Setup, shards take any Set options
+  struct ShardedSet* s = ShardedSet_new_with_options(
+    16, 4, SET_INCREMENTAL_RESIZE | SET_ARENA_KEYS, wyhash, 0);
+  char key[16];
+
+  // Test put, has and delete on one thread
+  for (int i = 0; i < 200; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(ShardedSet_put(s, key, key_len), ==, 1);
+  }
+
+  munit_assert_int(ShardedSet_put(s, "key-7", 5), ==, 0);
+  munit_assert_size(ShardedSet_load(s), ==, 200);
+
+  for (int i = 0; i < 200; i += 2) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    ShardedSet_delete(s, key, key_len);
+  }
+
+  for (int i = 0; i < 200; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    munit_assert_int(ShardedSet_has(s, key, key_len), ==, i % 2);
+  }
+
+  // Test each key is only in the shard its hash routes to
+  for (size_t i = 0; i < s->base.segment_count; i++) {
+    munit_assert_size(s->base.segments[i].set->load, >, 0);
+  }
+  for (int i = 1; i < 200; i += 2) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    size_t shard = wyhash(key, key_len, 0) >> 62;
+    for (size_t j = 0; j < s->base.segment_count; j++) {
+      munit_assert_int(
+        Set_has(s->base.segments[j].set, key, key_len), ==, j == shard);
+    }
+  }
+
+  // Teardown
+  ShardedSet_free(s);
+
+  return MUNIT_OK;
+}
+
+struct worker
+{
+  struct ShardedSet* s;
+  int start;
+  int added;
+};
+
+static void*
+worker_run(void* arg)
+{
+  struct worker* w = arg;
+  char key[16];
+
+  // Each range overlaps with the next worker's
+  for (int i = w->start; i < w->start + 2000; i++) {
+    int key_len = snprintf(key, sizeof(key), "key-%d", i);
+    w->added += ShardedSet_put(w->s, key, key_len);
+  }
+
+  return NULL;
+}
+
+static MunitResult
+test_ShardedSet_threads()
+{
+  // Setup
+  struct ShardedSet* s = ShardedSet_new(16, 8);
+  struct worker workers[4];
+  pthread_t threads[4];
+
+  // Test concurrent writers add every key exactly once
+  for (int i = 0; i < 4; i++) {
+    workers[i] = (struct worker){ .s = s, .start = i * 1000, .added = 0 };
+    pthread_create(&threads[i], NULL, worker_run, &workers[i]);
+  }
+
+  int added = 0;
+  for (int i = 0; i < 4; i++) {
+    pthread_join(threads[i], NULL);
+    added += workers[i].added;
+  }
+
+  munit_assert_int(added, ==, 5000);
+  munit_assert_size(ShardedSet_load(s), ==, 5000);
+
+  // Teardown
+  ShardedSet_free(s);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_ShardedSet_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/put", test_ShardedSet_put, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/threads", test_ShardedSet_threads, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/ShardedSet", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
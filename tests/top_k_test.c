@@ -0,0 +1,151 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "munit.h"
+#include "top_k.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static MunitResult
+test_TopK_new()
+{
+  // Test new starts empty
+  struct TopK* t = TopK_new(10, 0.001, 0.01);
+  struct TopKItem* items[10];
+
+  munit_assert_size(t->len, ==, 0);
+  munit_assert_size(TopK_list(t, items), ==, 0);
+
+  // Test a k of 0 counts keys without tracking any
+  struct TopK* empty = TopK_new(0, 0.001, 0.01);
+
+  munit_assert_uint32(TopK_add(empty, "apple", 5, 3), ==, 3);
+  munit_assert_uint32(TopK_add(empty, "apple", 5, 2), ==, 5);
+  munit_assert_size(empty->len, ==, 0);
+  munit_assert_size(TopK_list(empty, items), ==, 0);
+
+  // Teardown
+  TopK_free(t);
+  TopK_free(empty);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_TopK_add()
+{
+  // Setup, key i is added 2000 / (i + 1) times, interleaved so the heavy
+  // keys have to evict light ones that arrived first
+  struct TopK* t = TopK_new(10, 0.0001, 0.01);
+  char key[64];
+
+  for (int round = 0; round < 2000; round++) {
+    for (int i = 1999; i >= 0; i--) {
+      if (round < 2000 / (i + 1)) {
+        int key_len =
+          snprintf(key, sizeof(key), "a-key-longer-than-inline-%d", i);
+        TopK_add(t, key, key_len, 1);
+      }
+    }
+  }
+
+  // Test the ten heaviest keys are listed heaviest first
+  struct TopKItem* items[10];
+  munit_assert_size(TopK_list(t, items), ==, 10);
+
+  for (int i = 0; i < 10; i++) {
+    int key_len = snprintf(key, sizeof(key), "a-key-longer-than-inline-%d", i);
+    munit_assert_size(items[i]->key_len, ==, (size_t)key_len);
+    munit_assert_memory_equal(key_len, items[i]->key, key);
+    munit_assert_uint32(items[i]->count, ==, 2000 / (i + 1));
+  }
+
+  // Test the heap and map agree after evictions
+  for (size_t i = 0; i < t->len; i++) {
+    munit_assert_size(t->heap[i]->index, ==, i);
+    munit_assert_ptr_equal(
+      Map_get(t->items, t->heap[i]->key, t->heap[i]->key_len), t->heap[i]);
+  }
+  munit_assert_size(t->items->set->load, ==, 10);
+
+  // Test long keys are stored once, in the map
+  for (size_t i = 0; i < t->len; i++) {
+    struct SetItem* stored =
+      Set_get(t->items->set, t->heap[i]->key, t->heap[i]->key_len);
+    munit_assert_ptr_equal(stored->key, t->heap[i]->key);
+  }
+
+  // Teardown
+  TopK_free(t);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_TopK_inline_keys()
+{
+  // Setup, same stream as test_TopK_add with keys the map stores inline,
+  // whose slots move as evicted keys are deleted
+  struct TopK* t = TopK_new(10, 0.0001, 0.01);
+  char key[16];
+
+  for (int round = 0; round < 2000; round++) {
+    for (int i = 1999; i >= 0; i--) {
+      if (round < 2000 / (i + 1)) {
+        int key_len = snprintf(key, sizeof(key), "k-%d", i);
+        TopK_add(t, key, key_len, 1);
+      }
+    }
+  }
+
+  // Test the items keep their own copies of the keys
+  struct TopKItem* items[10];
+  munit_assert_size(TopK_list(t, items), ==, 10);
+
+  for (int i = 0; i < 10; i++) {
+    int key_len = snprintf(key, sizeof(key), "k-%d", i);
+    munit_assert_ptr_equal(items[i]->key, items[i]->inline_key);
+    munit_assert_size(items[i]->key_len, ==, (size_t)key_len);
+    munit_assert_memory_equal(key_len, items[i]->key, key);
+    munit_assert_uint32(items[i]->count, ==, 2000 / (i + 1));
+  }
+
+  // Teardown
+  TopK_free(t);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_TopK_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/add", test_TopK_add, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/inline_keys", test_TopK_inline_keys, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/TopK", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}
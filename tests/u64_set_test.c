@@ -0,0 +1,187 @@
+/*
+ * Copyright 2023 Adam Bishop Comer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+
+#include "munit.h"
+#include "u64_set.h"
+#include <stddef.h>
+#include <stdint.h>
+
+static MunitResult
+test_U64Set_new()
+{
+  // Test new rounds the capacity up to a power of two
+  struct U64Set* s = U64Set_new(100);
+
+  munit_assert_size(s->capacity, ==, 128);
+  munit_assert_size(s->load, ==, 0);
+  munit_assert_uint(s->shift, ==, 57);
+
+  for (size_t i = 0; i < s->capacity; i++) {
+    munit_assert_uint64(s->table[i], ==, 0);
+  }
+
+  // Teardown
+  U64Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_U64Set_put()
+{
+  // Setup
+  struct U64Set* s = U64Set_new(2);
+
+  // Test put through several expansions
+  for (uint64_t i = 1; i <= 1000; i++) {
+    munit_assert_int(U64Set_put(s, i * 7919), ==, 1);
+  }
+
+  munit_assert_int(U64Set_put(s, 7919), ==, 0);
+  munit_assert_size(s->load, ==, 1000);
+  munit_assert_size(s->capacity, ==, 2048);
+
+  for (uint64_t i = 1; i <= 1000; i++) {
+    munit_assert_int(U64Set_has(s, i * 7919), ==, 1);
+    munit_assert_int(U64Set_has(s, i * 7919 + 1), ==, 0);
+  }
+
+  // Teardown
+  U64Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_U64Set_zero()
+{
+  // Setup
+  struct U64Set* s = U64Set_new(8);
+
+  // Test the empty marker is still a valid key
+  munit_assert_int(U64Set_has(s, 0), ==, 0);
+  munit_assert_int(U64Set_put(s, 0), ==, 1);
+  munit_assert_int(U64Set_put(s, 0), ==, 0);
+  munit_assert_int(U64Set_has(s, 0), ==, 1);
+  munit_assert_size(s->load, ==, 1);
+
+  U64Set_delete(s, 0);
+
+  munit_assert_int(U64Set_has(s, 0), ==, 0);
+  munit_assert_size(s->load, ==, 0);
+
+  // Teardown
+  U64Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_U64Set_delete()
+{
+  // Setup
+  struct U64Set* s = U64Set_new(64);
+  uint64_t x = 1;
+
+  uint64_t keys[500];
+  for (size_t i = 0; i < 500; i++) {
+    x = x * 6364136223846793005u + 1442695040888963407u;
+    keys[i] = x | 1;
+    U64Set_put(s, keys[i]);
+  }
+
+  // Test deleting every other key keeps the rest reachable
+  for (size_t i = 0; i < 500; i += 2) {
+    U64Set_delete(s, keys[i]);
+  }
+  U64Set_delete(s, 2);
+
+  munit_assert_size(s->load, ==, 250);
+
+  for (size_t i = 0; i < 500; i++) {
+    munit_assert_int(U64Set_has(s, keys[i]), ==, (int)(i % 2));
+  }
+
+  // Test no key sits after an empty slot on its probe sequence
+  size_t mask = s->capacity - 1;
+  for (size_t i = 0; i < s->capacity; i++) {
+    if (s->table[i] == 0) {
+      continue;
+    }
+    size_t home = (size_t)((s->table[i] * 11400714819323198485u) >> s->shift);
+    for (size_t j = home; j != i; j = (j + 1) & mask) {
+      munit_assert_uint64(s->table[j], !=, 0);
+    }
+  }
+
+  // Teardown
+  U64Set_free(s);
+
+  return MUNIT_OK;
+}
+
+static MunitResult
+test_U64SetIterator()
+{
+  // Setup
+  struct U64Set* s = U64Set_new(8);
+
+  U64Set_put(s, 0);
+  for (uint64_t i = 1; i <= 10; i++) {
+    U64Set_put(s, i);
+  }
+
+  // Test the iterator visits every key once, including 0
+  struct U64SetIterator* iterator = U64SetIterator_new(s);
+
+  uint64_t key;
+  uint64_t sum = 0;
+  size_t count = 0;
+  while (U64SetIterator_next(iterator, &key)) {
+    sum += key;
+    count += 1;
+  }
+
+  munit_assert_size(count, ==, 11);
+  munit_assert_uint64(sum, ==, 55);
+
+  // Teardown
+  U64SetIterator_free(iterator);
+  U64Set_free(s);
+
+  return MUNIT_OK;
+}
+
+// clang-format off
+static MunitTest test_suite_tests[] = {
+  {"/new", test_U64Set_new, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/put", test_U64Set_put, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/zero", test_U64Set_zero, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/delete", test_U64Set_delete, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {"/iterator", test_U64SetIterator, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+  {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+static const MunitSuite test_suite = {"/U64Set", test_suite_tests,  NULL, 1, MUNIT_SUITE_OPTION_NONE};
+// clang-format on
+
+int
+main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)])
+{
+  return munit_suite_main(&test_suite, NULL, argc, argv);
+}